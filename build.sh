@@ -7,14 +7,28 @@ echo "[*] 빌드 시작..."
 # 빌드 디렉토리 준비
 mkdir -p build
 
+# TRACE=1 ./build.sh 로 트레이스 포인트 포함 빌드 (SIGUSR1 또는 종료 시 *_trace.json 덤프)
+CXXFLAGS=""
+if [ "${TRACE:-0}" = "1" ]; then
+    CXXFLAGS="-DPIDRONE_TRACE"
+fi
+
+# 공용 라이브러리 소스
+LIB_SRCS="src/lib/PCA9635_RPI.cpp src/lib/FxTrack.cpp src/lib/ShowTrack.cpp src/lib/FrameStore.cpp src/lib/Timeline.cpp src/lib/EventSignal.cpp src/lib/AsyncLog.cpp src/lib/Trace.cpp src/lib/Checkpoint.cpp src/lib/Schedule.cpp src/lib/DroneLeds.cpp"
+
 # 실행 파일 빌드
 echo "[*] rpi_play 빌드..."
-g++ src/rpi_play.cpp src/lib/PCA9635_RPI.cpp -o build/rpi_play
+g++ $CXXFLAGS src/rpi_play.cpp $LIB_SRCS -o build/rpi_play -lpthread
 
 echo "[*] rpi_play_pwm 빌드..."
-g++ -o build/rpi_play_pwm \
-    src/rpi_play_pwm.cpp src/lib/PCA9635_RPI.cpp \
+g++ $CXXFLAGS -o build/rpi_play_pwm \
+    src/rpi_play_pwm.cpp $LIB_SRCS \
     -lpigpio -lrt -lpthread
 
+# 스웜 시뮬레이터 (하드웨어 불필요, 가상 I2C 버스로 실행)
+echo "[*] swarm_sim 빌드..."
+g++ -O2 $CXXFLAGS src/swarm_sim.cpp $LIB_SRCS -o build/swarm_sim -lpthread
+
 chmod +x build/rpi_play
-chmod +x build/rpi_play_pwm
\ No newline at end of file
+chmod +x build/rpi_play_pwm
+chmod +x build/swarm_sim
\ No newline at end of file
@@ -0,0 +1,55 @@
+import json
+import struct
+import sys
+import time
+
+# Builds an effect track (.fx) from a JSON description, e.g.
+# {"segments": [
+#     {"type": "solid",    "frames": 100, "color": [255, 255, 255]},
+#     {"type": "fade",     "frames": 100, "from": [255, 255, 255], "to": [0, 0, 0]},
+#     {"type": "chase",    "frames": 200, "color": [255, 0, 0], "background": [0, 0, 0], "width": 2, "period": 3},
+#     {"type": "gradient", "frames": 200, "from": [255, 0, 0], "to": [0, 0, 255], "period": 5},
+#     {"type": "strobe",   "frames": 100, "color": [255, 255, 255], "width": 1, "period": 4},
+#     {"type": "curve",    "frames": 300, "keys": [[0, [0, 0, 0]], [150, [0, 255, 0]], [299, [0, 0, 0]]]}
+# ]}
+# Layout must match src/lib/FxTrack.h.
+
+FX_TYPES = {"solid": 0, "fade": 1, "chase": 2, "gradient": 3, "strobe": 4, "curve": 5}
+END_MARKER = 0xdeadbeef
+
+
+def encode_segment(seg):
+    kind = FX_TYPES[seg["type"]]
+    frames = int(seg["frames"])
+    color_a = seg.get("color", seg.get("from", [0, 0, 0]))
+    color_b = seg.get("background", seg.get("to", [0, 0, 0]))
+    keys = seg.get("keys", [])
+
+    out = struct.pack("<BBHI3B3BBB", kind, seg.get("width", 0), seg.get("period", 0), frames,
+                      *color_a, *color_b, len(keys), 0)
+    for frame, rgb in keys:
+        out += struct.pack("<I3BB", frame, *rgb, 0)
+    return out, frames
+
+
+def build(spec):
+    body = b""
+    total = 0
+    for seg in spec["segments"]:
+        data, frames = encode_segment(seg)
+        body += data
+        total += frames
+
+    header = b"PDFX" + struct.pack("<BBHII", 1, 0, len(spec["segments"]), 0, 0)
+    trailer = struct.pack("<IQI", total, int(time.time() * 1000), END_MARKER)
+    return header + body + trailer
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print(f"Usage: {sys.argv[0]} <spec.json> <out.fx>")
+        sys.exit(1)
+    with open(sys.argv[1]) as f:
+        spec = json.load(f)
+    with open(sys.argv[2], "wb") as f:
+        f.write(build(spec))
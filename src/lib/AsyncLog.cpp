@@ -0,0 +1,165 @@
+#include "AsyncLog.h"
+#include "EventSignal.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+
+struct LogRecord {
+    LogSite* site;
+    int64_t args[2];
+    int32_t err;
+    uint32_t suppressed;
+};
+
+// Single producer (the owning thread), single consumer (whoever holds drainMutex)
+struct LogRing {
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> dropped{0};
+    LogRecord records[LOG_RING_SIZE];
+};
+
+static std::atomic<LogRing*> rings[LOG_MAX_THREADS];
+static std::atomic<int> ringCount(0);
+static std::atomic<uint32_t> droppedThreads(0);   // logs from threads beyond LOG_MAX_THREADS
+static std::atomic<bool> pending(false);
+static EventSignal logEvent;
+static std::mutex drainMutex;
+static std::map<LogSite*, LogRecord> lastRecords; // guarded by drainMutex
+static thread_local LogRing* threadRing = nullptr;
+
+// INFO lines carry their own [TAG] like the rest of the players' output
+static const char* levelPrefix[] = { "", "[WARN] ", "[ERROR] " };
+
+static int64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// First log from a thread allocates its ring; after that logging never allocates
+static LogRing* ringForThread() {
+    if (threadRing) return threadRing;
+    int slot = ringCount.load();
+    if (slot >= LOG_MAX_THREADS) return nullptr;
+    LogRing* ring = new LogRing();
+    slot = ringCount.fetch_add(1);
+    if (slot >= LOG_MAX_THREADS) {
+        delete ring;
+        return nullptr;
+    }
+    rings[slot] = ring;
+    threadRing = ring;
+    return ring;
+}
+
+void asyncLog(LogSite& site, int err, int64_t a0, int64_t a1) {
+    int64_t now = monotonicNs();
+    int64_t last = site.lastNs.load(std::memory_order_relaxed);
+    if ((last != 0 && now - last < LOG_INTERVAL_MS * 1000000) ||
+        !site.lastNs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    LogRing* ring = ringForThread();
+    if (!ring) {
+        droppedThreads.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= static_cast<uint32_t>(LOG_RING_SIZE)) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    LogRecord& rec = ring->records[head & (LOG_RING_SIZE - 1)];
+    rec.site = &site;
+    rec.args[0] = a0;
+    rec.args[1] = a1;
+    rec.err = err;
+    rec.suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+
+    // Only the first record after the writer went idle costs a syscall
+    if (!pending.exchange(true)) logEvent.notify();
+}
+
+static void writeRecord(const LogRecord& rec) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), rec.site->format,
+             static_cast<long long>(rec.args[0]), static_cast<long long>(rec.args[1]));
+
+    char line[384];
+    int len = snprintf(line, sizeof(line), "%s%s", levelPrefix[rec.site->level], msg);
+    if (rec.err != 0 && len < static_cast<int>(sizeof(line))) {
+        len += snprintf(line + len, sizeof(line) - len, ": %s", strerror(rec.err));
+    }
+    if (rec.suppressed != 0 && len < static_cast<int>(sizeof(line))) {
+        snprintf(line + len, sizeof(line) - len, " (x%u suppressed)", rec.suppressed);
+    }
+    fprintf(stderr, "%s\n", line);
+}
+
+static void drain(bool final) {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    int count = std::min(ringCount.load(), LOG_MAX_THREADS);
+    for (int i = 0; i < count; ++i) {
+        LogRing* ring = rings[i].load();
+        if (!ring) continue;   // slot claimed, ring not published yet
+
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const LogRecord& rec = ring->records[tail & (LOG_RING_SIZE - 1)];
+            lastRecords[rec.site] = rec;
+            writeRecord(rec);
+        }
+        ring->tail.store(tail, std::memory_order_release);
+
+        uint32_t dropped = ring->dropped.exchange(0);
+        if (dropped) fprintf(stderr, "[WARN] log ring full, %u messages dropped\n", dropped);
+    }
+
+    uint32_t lost = droppedThreads.exchange(0);
+    if (lost) fprintf(stderr, "[WARN] %u messages dropped from unregistered threads\n", lost);
+
+    // Bursts that ended inside their rate-limit window are reported here
+    if (final) {
+        for (auto& entry : lastRecords) {
+            LogRecord rec = entry.second;
+            rec.suppressed = entry.first->suppressed.exchange(0);
+            if (rec.suppressed) writeRecord(rec);
+        }
+    }
+    fflush(stderr);
+}
+
+static void writerLoop() {
+    // Players run under chrt -f 99 and new threads inherit that; formatting
+    // and writing stderr must not compete with the frame loop
+    struct sched_param param = {};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+
+    while (true) {
+        logEvent.wait();
+        pending.store(false);
+        drain(false);
+    }
+}
+
+void asyncLogStart() {
+    // Detached: the writer must never hold up exit()
+    std::thread(writerLoop).detach();
+}
+
+void asyncLogFlush() {
+    drain(true);
+}
@@ -0,0 +1,50 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <atomic>
+
+// Logging for real-time threads. A log call copies a fixed-size record into
+// the calling thread's lock-free ring and returns; a background thread does
+// the formatting and the write to stderr. Each call site is rate-limited:
+// repeats within LOG_INTERVAL_MS are only counted and reported with the next
+// record that gets through ("x N suppressed"). INFO messages are printed
+// without a level prefix and are expected to start with their own [TAG].
+
+const int LOG_LEVEL_INFO  = 0;
+const int LOG_LEVEL_WARN  = 1;
+const int LOG_LEVEL_ERROR = 2;
+
+const int64_t LOG_INTERVAL_MS = 1000;
+const int LOG_RING_SIZE       = 256;   // records per thread, power of two
+const int LOG_MAX_THREADS     = 16;
+
+// One per call site, created by the LOG_* macros
+struct LogSite {
+    const char* format;   // printf format taking up to two long long arguments
+    int level;
+    std::atomic<int64_t> lastNs;
+    std::atomic<uint32_t> suppressed;
+};
+
+// Starts the writer thread; records logged before this are kept until it runs
+void asyncLogStart();
+// Writes out everything queued so far, including pending suppressed counts.
+// Call before exit() so the last messages are not lost.
+void asyncLogFlush();
+
+void asyncLog(LogSite& site, int err, int64_t a0, int64_t a1);
+
+#define ASYNC_LOG_AT(level, err, fmt, a0, a1) do {                          \
+        static LogSite _logSite = { fmt, level, {0}, {0} };                 \
+        asyncLog(_logSite, err, (int64_t)(a0), (int64_t)(a1));              \
+    } while (0)
+
+#define LOG_INFO(fmt, a0, a1)  ASYNC_LOG_AT(LOG_LEVEL_INFO, 0, fmt, a0, a1)
+#define LOG_WARN(fmt, a0, a1)  ASYNC_LOG_AT(LOG_LEVEL_WARN, 0, fmt, a0, a1)
+#define LOG_ERROR(fmt, a0, a1) ASYNC_LOG_AT(LOG_LEVEL_ERROR, 0, fmt, a0, a1)
+// Like LOG_ERROR, with strerror(errno) appended as perror() would
+#define LOG_ERRNO(fmt, a0, a1) ASYNC_LOG_AT(LOG_LEVEL_ERROR, errno, fmt, a0, a1)
+
+#endif // ASYNC_LOG_H
@@ -0,0 +1,103 @@
+#include "Checkpoint.h"
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <atomic>
+
+const uint32_t CHECKPOINT_MAGIC   = 0x50434b50; // "PKCP"
+const uint32_t CHECKPOINT_VERSION = 1;
+
+struct Checkpoint::Shared {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> seq;   // odd while a write is in progress
+    uint32_t valid;
+    CheckpointState state;
+};
+
+uint64_t checkpointHash(const std::string& playlist, int frameSize) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : playlist) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    h ^= static_cast<uint64_t>(frameSize);
+    h *= 1099511628211ULL;
+    return h;
+}
+
+Checkpoint::Checkpoint() {
+    shared = nullptr;
+    fd = -1;
+}
+
+Checkpoint::~Checkpoint() {
+    if (shared) munmap(shared, sizeof(Shared));
+    if (fd >= 0) close(fd);
+}
+
+bool Checkpoint::open(const char* path) {
+    fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("Failed to open checkpoint");
+        return false;
+    }
+    if (ftruncate(fd, sizeof(Shared)) < 0) {
+        perror("Failed to size checkpoint");
+        return false;
+    }
+    void* mem = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        perror("Failed to map checkpoint");
+        return false;
+    }
+    shared = static_cast<Shared*>(mem);
+    return true;
+}
+
+bool Checkpoint::read(CheckpointState& out) const {
+    if (!shared || shared->magic != CHECKPOINT_MAGIC || shared->version != CHECKPOINT_VERSION) return false;
+
+    // The writer is normally dead by now, but a torn read costs little to rule out
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        uint32_t before = shared->seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        bool valid = shared->valid != 0;
+        out = shared->state;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (shared->seq.load(std::memory_order_relaxed) == before) return valid;
+    }
+    return false;
+}
+
+void Checkpoint::begin(const CheckpointState& state) {
+    if (!shared) return;
+    uint32_t seq = shared->seq.load(std::memory_order_relaxed);
+    shared->seq.store(seq | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    shared->magic = CHECKPOINT_MAGIC;
+    shared->version = CHECKPOINT_VERSION;
+    shared->state = state;
+    shared->valid = 1;
+    shared->seq.store((seq | 1) + 1, std::memory_order_release);
+}
+
+void Checkpoint::publish(uint32_t entry, uint64_t frame) {
+    if (!shared) return;
+    uint32_t seq = shared->seq.load(std::memory_order_relaxed);
+    shared->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    shared->state.entry = entry;
+    shared->state.frame = frame;
+    shared->seq.store(seq + 2, std::memory_order_release);
+}
+
+void Checkpoint::clear() {
+    if (!shared) return;
+    uint32_t seq = shared->seq.load(std::memory_order_relaxed);
+    shared->seq.store(seq | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    shared->valid = 0;
+    shared->seq.store((seq | 1) + 1, std::memory_order_release);
+}
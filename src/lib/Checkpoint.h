@@ -0,0 +1,48 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+
+// Playback position shared with whichever player runs next. Lives in tmpfs,
+// so it survives a crash or SIGTERM of the player but not a reboot (which
+// also resets CLOCK_MONOTONIC, the clock the anchor is expressed in).
+const char* const CHECKPOINT_PATH = "/dev/shm/pidrone_checkpoint";
+
+struct CheckpointState {
+    uint64_t playlistHash;   // identifies the playlist and frame size the layout came from
+    int64_t originNs;        // system_clock time the timeline layout was computed against
+    struct timespec anchor;  // CLOCK_MONOTONIC time of timeline frame 0
+    uint64_t endFrame;
+    uint32_t entry;          // entry showing `frame`
+    uint64_t frame;          // last timeline frame written to the LEDs
+};
+
+// FNV-1a over the playlist text, mixed with the frame size
+uint64_t checkpointHash(const std::string& playlist, int frameSize);
+
+// mmap'd checkpoint guarded by a sequence counter, so publishing a frame is a
+// few plain stores (no syscalls) and a reader never sees a half-written state.
+class Checkpoint {
+public:
+    Checkpoint();
+    ~Checkpoint();
+
+    bool open(const char* path);
+    // False if there is no complete, valid checkpoint
+    bool read(CheckpointState& out) const;
+    // Starts a new run: writes the whole state
+    void begin(const CheckpointState& state);
+    // Called after every frame
+    void publish(uint32_t entry, uint64_t frame);
+    // Marks the run finished so the next player starts fresh
+    void clear();
+
+private:
+    struct Shared;
+    Shared* shared;
+    int fd;
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,51 @@
+#include "DroneLeds.h"
+
+DroneLeds::DroneLeds(PCA9635& pca1, PCA9635& pca2, PCA9635& pca3) {
+    this->pca1 = &pca1;
+    this->pca2 = &pca2;
+    this->pca3 = &pca3;
+}
+
+RGBChannel DroneLeds::getLEDChannel(int ledIndex) const {
+    switch (ledIndex) {
+        case 0: return {{pca1, 0}, {pca1, 1}, {pca1, 2}};
+        case 1: return {{pca1, 3}, {pca1, 4}, {pca1, 5}};
+        case 2: return {{pca1, 6}, {pca1, 7}, {pca1, 8}};
+        case 3: return {{pca1, 9}, {pca1, 10}, {pca1, 11}};
+        case 4: return {{pca1, 12}, {pca1, 13}, {pca1, 14}};
+        case 5: return {{pca1, 15}, {pca2, 0}, {pca2, 1}};
+        case 6: return {{pca2, 2}, {pca2, 3}, {pca2, 4}};
+        case 7: return {{pca2, 5}, {pca2, 6}, {pca2, 7}};
+        case 8: return {{pca2, 8}, {pca2, 9}, {pca2, 10}};
+        case 9: return {{pca2, 11}, {pca2, 12}, {pca2, 13}};
+        case 10:return {{pca2, 14}, {pca2, 15}, {pca3, 0}};
+        case 11:return {{pca3, 1}, {pca3, 2}, {pca3, 3}};
+        case 12:return {{pca3, 4}, {pca3, 5}, {pca3, 6}};
+        case 13:return {{pca3, 7}, {pca3, 8}, {pca3, 9}};
+        case 14:return {{pca3, 10}, {pca3, 11}, {pca3, 12}};
+        case 15:return {{pca3, 13}, {pca3, 14}, {pca3, 15}};
+        default:return {{nullptr, -1}, {nullptr, -1}, {nullptr, -1}};
+    }
+}
+
+void DroneLeds::setLED(int ledIndex, uint8_t r, uint8_t g, uint8_t b) {
+    RGBChannel ch = getLEDChannel(ledIndex);
+    int r_fixed = r * 2/3 ;
+    int b_fixed = b * 2/3 ;
+    if (ch.r.pca && ch.r.ch >= 0) ch.r.pca->analogWrite(ch.r.ch, r_fixed);
+    if (ch.g.pca && ch.g.ch >= 0) ch.g.pca->analogWrite(ch.g.ch, g);
+    if (ch.b.pca && ch.b.ch >= 0) ch.b.pca->analogWrite(ch.b.ch, b_fixed);
+}
+
+void DroneLeds::showFrame(const uint8_t* frame, int pixelCount) {
+    for (int i = 0; i < pixelCount; ++i) {
+        if (frame) setLED(i, frame[i * 3 + 0], frame[i * 3 + 1], frame[i * 3 + 2]);
+        else setLED(i, 0, 0, 0);
+    }
+}
+
+void DroneLeds::off() {
+    for (int i = 0; i < 16; ++i) {
+        setLED(i, 0, 0, 0);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef DRONE_LEDS_H
+#define DRONE_LEDS_H
+
+#include <stdint.h>
+#include "PCA9635_RPI.h"
+
+// Define LED control structures
+struct Channel {
+    PCA9635* pca;
+    int ch;
+};
+
+struct RGBChannel {
+    Channel r, g, b;
+};
+
+// The drone's 16 RGB LEDs, wired across three PCA9635 boards
+class DroneLeds {
+public:
+    DroneLeds(PCA9635& pca1, PCA9635& pca2, PCA9635& pca3);
+
+    // Map LED index (0~15) to the corresponding RGB PCA9635 channels
+    RGBChannel getLEDChannel(int ledIndex) const;
+    // Set the color of a specific LED (by index)
+    void setLED(int ledIndex, uint8_t r, uint8_t g, uint8_t b);
+    // Write one frame to the LEDs; nullptr (a gap in the timeline) turns them off
+    void showFrame(const uint8_t* frame, int pixelCount);
+    void off();
+
+private:
+    PCA9635* pca1;
+    PCA9635* pca2;
+    PCA9635* pca3;
+};
+
+#endif // DRONE_LEDS_H
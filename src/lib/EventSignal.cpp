@@ -0,0 +1,34 @@
+#include "EventSignal.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+EventSignal::EventSignal() {
+    event_fd = eventfd(0, EFD_CLOEXEC);
+    if (event_fd < 0) {
+        // wait() would return at once forever and its caller would spin
+        perror("Failed to create eventfd");
+        exit(1);
+    }
+}
+
+EventSignal::~EventSignal() {
+    if (event_fd >= 0) {
+        close(event_fd);
+    }
+}
+
+void EventSignal::notify() {
+    uint64_t one = 1;
+    // Only fails if the counter would overflow, which still leaves it readable
+    ssize_t ret = write(event_fd, &one, sizeof(one));
+    (void)ret;
+}
+
+void EventSignal::wait() {
+    uint64_t count;
+    while (read(event_fd, &count, sizeof(count)) < 0 && errno == EINTR) {
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef EVENT_SIGNAL_H
+#define EVENT_SIGNAL_H
+
+#include <stdint.h>
+
+// One-shot wakeup for a thread blocked with nothing to do, backed by an eventfd.
+// notify() may be called from any thread or from a signal handler; notifications
+// sent before wait() are not lost, and several of them collapse into one wakeup.
+// Failing to create the eventfd is fatal.
+class EventSignal {
+public:
+    EventSignal();
+    ~EventSignal();
+
+    void notify();
+    // Blocks until notified
+    void wait();
+
+private:
+    int event_fd;
+};
+
+#endif // EVENT_SIGNAL_H
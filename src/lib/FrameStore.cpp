@@ -0,0 +1,106 @@
+#include "FrameStore.h"
+#include <string.h>
+#include <iostream>
+#include <map>
+#include <memory>
+
+FrameStore::FrameStore(int frameSize) {
+    _frameSize = frameSize;
+    chunkCount = 0;
+    nextSlot = 0;
+    memset(chunks, 0, sizeof(chunks));
+}
+
+FrameStore::~FrameStore() {
+    for (uint32_t i = 0; i < chunkCount; ++i) delete[] chunks[i];
+}
+
+FrameStore& FrameStore::shared(int frameSize) {
+    // Never destroyed: tracks held in globals release their frames during
+    // static destruction, possibly after this function's statics are gone
+    static std::mutex* storesMutex = new std::mutex;
+    static std::map<int, std::unique_ptr<FrameStore>>* stores = new std::map<int, std::unique_ptr<FrameStore>>;
+
+    std::lock_guard<std::mutex> lock(*storesMutex);
+    std::unique_ptr<FrameStore>& store = (*stores)[frameSize];
+    if (!store) store.reset(new FrameStore(frameSize));
+    return *store;
+}
+
+// FNV-1a, a word at a time
+uint64_t FrameStore::hash(const uint8_t* data) const {
+    uint64_t h = 1469598103934665603ULL;
+    int i = 0;
+    for (; i + 8 <= _frameSize; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h ^= word;
+        h *= 1099511628211ULL;
+    }
+    for (; i < _frameSize; ++i) {
+        h ^= data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+FrameId FrameStore::intern(const uint8_t* data) {
+    uint64_t h = hash(data);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto range = index.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (memcmp(this->data(it->second), data, _frameSize) == 0) {
+            ++refs[it->second];
+            return it->second;
+        }
+    }
+
+    FrameId id;
+    if (!freeSlots.empty()) {
+        id = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        if ((nextSlot >> FRAME_STORE_CHUNK_SHIFT) >= chunkCount) {
+            if (chunkCount == FRAME_STORE_MAX_CHUNKS) {
+                std::cerr << "[ERROR] Frame store full (" << nextSlot << " unique frames)\n";
+                return FRAME_ID_NONE;
+            }
+            chunks[chunkCount++] = new uint8_t[static_cast<size_t>(FRAME_STORE_CHUNK_FRAMES) * _frameSize];
+            refs.resize(static_cast<size_t>(chunkCount) * FRAME_STORE_CHUNK_FRAMES, 0);
+        }
+        id = nextSlot++;
+    }
+
+    memcpy(chunks[id >> FRAME_STORE_CHUNK_SHIFT] + (id & (FRAME_STORE_CHUNK_FRAMES - 1)) * _frameSize,
+           data, _frameSize);
+    refs[id] = 1;
+    index.emplace(h, id);
+    return id;
+}
+
+void FrameStore::release(FrameId id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Unknown or already freed ids are ignored; data(id) is only valid past this check
+    if (id >= nextSlot || refs[id] == 0 || --refs[id] > 0) return;
+
+    uint64_t h = hash(data(id));
+    auto range = index.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == id) {
+            index.erase(it);
+            break;
+        }
+    }
+    freeSlots.push_back(id);
+}
+
+uint32_t FrameStore::uniqueFrames() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<uint32_t>(index.size());
+}
+
+size_t FrameStore::residentBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<size_t>(chunkCount) * FRAME_STORE_CHUNK_FRAMES * _frameSize;
+}
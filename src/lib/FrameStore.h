@@ -0,0 +1,57 @@
+#ifndef FRAME_STORE_H
+#define FRAME_STORE_H
+
+#include <stdint.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+typedef uint32_t FrameId;
+const FrameId FRAME_ID_NONE = 0xffffffff;
+
+const int FRAME_STORE_CHUNK_SHIFT = 12;                         // 4096 frames per chunk
+const int FRAME_STORE_CHUNK_FRAMES = 1 << FRAME_STORE_CHUNK_SHIFT;
+const int FRAME_STORE_MAX_CHUNKS = 1024;                        // up to 4M unique frames
+
+// Content-addressed storage for fixed-size frames. Identical frames, within a
+// show or across shows, are kept once and shared through a reference count,
+// so memory grows with the number of distinct frames rather than show length.
+//
+// Frames live in chunks that never move once allocated, so data() takes no
+// lock and stays valid for as long as the caller holds a reference.
+// intern() and release() may run on a loader thread during playback.
+class FrameStore {
+public:
+    explicit FrameStore(int frameSize);
+    ~FrameStore();
+
+    // Store shared by every track with this frame size
+    static FrameStore& shared(int frameSize);
+
+    // Returns the id of a frame equal to `data` (frameSize bytes), adding it
+    // if it is new, and takes a reference on it. FRAME_ID_NONE if the store is full.
+    FrameId intern(const uint8_t* data);
+    void release(FrameId id);
+
+    const uint8_t* data(FrameId id) const {
+        return chunks[id >> FRAME_STORE_CHUNK_SHIFT] + (id & (FRAME_STORE_CHUNK_FRAMES - 1)) * _frameSize;
+    }
+
+    int frameSize() const { return _frameSize; }
+    uint32_t uniqueFrames() const;
+    size_t residentBytes() const;
+
+private:
+    uint64_t hash(const uint8_t* data) const;
+
+    int _frameSize;
+    uint8_t* chunks[FRAME_STORE_MAX_CHUNKS];
+    uint32_t chunkCount;
+    uint32_t nextSlot;                              // slots below this have been handed out
+    std::vector<uint32_t> refs;                     // per slot, 0 = free
+    std::vector<FrameId> freeSlots;
+    std::unordered_multimap<uint64_t, FrameId> index;
+    mutable std::mutex mutex;
+};
+
+#endif // FRAME_STORE_H
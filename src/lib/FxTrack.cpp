@@ -0,0 +1,194 @@
+#include "FxTrack.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+FxTrack::FxTrack() {
+    _frameCount = 0;
+}
+
+bool FxTrack::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "[ERROR] Cannot open effect file: " << path << "\n";
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (data.size() < static_cast<size_t>(FX_HEADER_SIZE + FX_TRAILER_SIZE)) {
+        std::cerr << "[ERROR] Effect file too short: " << path << "\n";
+        return false;
+    }
+
+    uint32_t magic;
+    uint16_t segmentCount;
+    std::memcpy(&magic, data.data(), 4);
+    std::memcpy(&segmentCount, data.data() + 6, 2);
+    if (magic != FX_MAGIC || data[4] != FX_VERSION) {
+        std::cerr << "[ERROR] Not a version " << int(FX_VERSION) << " effect file: " << path << "\n";
+        return false;
+    }
+
+    uint32_t frameCnt;
+    uint32_t endMarker;
+    const uint8_t* trailer = data.data() + data.size() - FX_TRAILER_SIZE;
+    std::memcpy(&frameCnt,  trailer,      4);
+    std::memcpy(&endMarker, trailer + 12, 4);
+    if (endMarker != FX_END_MARKER) {
+        std::cerr << "[ERROR] Bad end marker in effect file: " << path << "\n";
+        return false;
+    }
+
+    segments.clear();
+    keys.clear();
+    _frameCount = 0;
+
+    size_t pos = FX_HEADER_SIZE;
+    const size_t bodyEnd = data.size() - FX_TRAILER_SIZE;
+    for (uint16_t s = 0; s < segmentCount; ++s) {
+        if (pos + FX_SEGMENT_SIZE > bodyEnd) {
+            std::cerr << "[ERROR] Truncated segment " << s << " in " << path << "\n";
+            return false;
+        }
+        const uint8_t* rec = data.data() + pos;
+        FxSegment seg;
+        seg.type  = rec[0];
+        seg.width = rec[1];
+        std::memcpy(&seg.period, rec + 2, 2);
+        std::memcpy(&seg.frames, rec + 4, 4);
+        std::memcpy(seg.colorA, rec + 8, 3);
+        std::memcpy(seg.colorB, rec + 11, 3);
+        seg.startFrame = _frameCount;
+        seg.firstKey = keys.size();
+        seg.keyCount = 0;
+        pos += FX_SEGMENT_SIZE;
+
+        if (seg.type > FX_CURVE || seg.frames == 0) {
+            std::cerr << "[ERROR] Invalid segment " << s << " (type " << int(seg.type)
+                      << ", frames " << seg.frames << ") in " << path << "\n";
+            return false;
+        }
+
+        if (seg.type == FX_CURVE) {
+            seg.keyCount = rec[14];
+            if (seg.keyCount == 0 || pos + seg.keyCount * FX_KEYFRAME_SIZE > bodyEnd) {
+                std::cerr << "[ERROR] Bad keyframes in segment " << s << " of " << path << "\n";
+                return false;
+            }
+            for (uint32_t k = 0; k < seg.keyCount; ++k) {
+                FxKeyframe key;
+                std::memcpy(&key.frame, data.data() + pos, 4);
+                std::memcpy(key.rgb, data.data() + pos + 4, 3);
+                if (k > 0 && key.frame <= keys.back().frame) {
+                    std::cerr << "[ERROR] Keyframes out of order in segment " << s << " of " << path << "\n";
+                    return false;
+                }
+                keys.push_back(key);
+                pos += FX_KEYFRAME_SIZE;
+            }
+        }
+
+        _frameCount += seg.frames;
+        segments.push_back(seg);
+    }
+
+    if (pos != bodyEnd || frameCnt != _frameCount) {
+        std::cerr << "[ERROR] Frame count mismatch in " << path << ": trailer " << frameCnt
+                  << ", segments " << _frameCount << "\n";
+        return false;
+    }
+    return true;
+}
+
+const FxSegment* FxTrack::findSegment(uint32_t index) const {
+    if (index >= _frameCount) return nullptr;
+    auto it = std::upper_bound(segments.begin(), segments.end(), index,
+        [](uint32_t f, const FxSegment& seg) { return f < seg.startFrame; });
+    return &*(it - 1);
+}
+
+void FxTrack::renderCurve(const FxSegment& seg, uint32_t t, uint8_t rgb[3]) const {
+    const FxKeyframe* first = &keys[seg.firstKey];
+    const FxKeyframe* last = first + seg.keyCount - 1;
+
+    const FxKeyframe* src = first;
+    const FxKeyframe* dst = first;
+    uint32_t w = 0;
+    if (t >= last->frame) {
+        src = dst = last;
+    } else if (t > first->frame) {
+        while ((src + 1)->frame <= t) ++src;
+        dst = src + 1;
+        w = static_cast<uint32_t>((static_cast<uint64_t>(t - src->frame) << 16) / (dst->frame - src->frame));
+    }
+    for (int c = 0; c < 3; ++c) rgb[c] = fxLerp(src->rgb[c], dst->rgb[c], w);
+}
+
+static void fillFrame(uint8_t* out, int pixelCount, const uint8_t rgb[3]) {
+    for (int i = 0; i < pixelCount; ++i) {
+        out[i * 3 + 0] = rgb[0];
+        out[i * 3 + 1] = rgb[1];
+        out[i * 3 + 2] = rgb[2];
+    }
+}
+
+void FxTrack::render(uint32_t index, uint8_t* out, int pixelCount) const {
+    const FxSegment* seg = findSegment(index);
+    if (!seg || pixelCount <= 0) {
+        std::memset(out, 0, pixelCount > 0 ? pixelCount * 3 : 0);
+        return;
+    }
+
+    const uint32_t t = index - seg->startFrame;
+    const uint32_t period = seg->period ? seg->period : 1;
+    const uint32_t width = seg->width ? seg->width : 1;
+    uint8_t rgb[3];
+
+    switch (seg->type) {
+        case FX_SOLID:
+            fillFrame(out, pixelCount, seg->colorA);
+            break;
+
+        case FX_FADE: {
+            uint32_t w = seg->frames > 1
+                ? static_cast<uint32_t>((static_cast<uint64_t>(t) << 16) / (seg->frames - 1))
+                : 65536;
+            for (int c = 0; c < 3; ++c) rgb[c] = fxLerp(seg->colorA[c], seg->colorB[c], w);
+            fillFrame(out, pixelCount, rgb);
+            break;
+        }
+
+        case FX_CHASE: {
+            uint32_t head = (t / period) % pixelCount;
+            for (int i = 0; i < pixelCount; ++i) {
+                uint32_t d = (i + pixelCount - head) % pixelCount;
+                const uint8_t* color = d < width ? seg->colorA : seg->colorB;
+                out[i * 3 + 0] = color[0];
+                out[i * 3 + 1] = color[1];
+                out[i * 3 + 2] = color[2];
+            }
+            break;
+        }
+
+        case FX_GRADIENT: {
+            uint32_t shift = seg->period ? (t / seg->period) % pixelCount : 0;
+            for (int i = 0; i < pixelCount; ++i) {
+                uint32_t p = (i + shift) % pixelCount;
+                uint32_t w = pixelCount > 1 ? (p << 16) / (pixelCount - 1) : 0;
+                for (int c = 0; c < 3; ++c) out[i * 3 + c] = fxLerp(seg->colorA[c], seg->colorB[c], w);
+            }
+            break;
+        }
+
+        case FX_STROBE:
+            fillFrame(out, pixelCount, (t % period) < width ? seg->colorA : seg->colorB);
+            break;
+
+        case FX_CURVE:
+            renderCurve(*seg, t, rgb);
+            fillFrame(out, pixelCount, rgb);
+            break;
+    }
+}
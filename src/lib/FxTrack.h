@@ -0,0 +1,71 @@
+#ifndef FX_TRACK_H
+#define FX_TRACK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Effect track (.fx) file layout, little-endian:
+//   header   16 bytes : "PDFX", version, reserved, segmentCount(u16), reserved
+//   segments 16 bytes each, CURVE segments followed by keyCount keyframes
+//   keyframe  8 bytes : frame offset in segment(u32), r, g, b, reserved
+//   trailer  16 bytes : frameCnt(u32), saveTime(u64), 0xdeadbeef (same as .bin)
+const uint32_t FX_MAGIC          = 0x58464450; // "PDFX"
+const uint8_t  FX_VERSION        = 1;
+const int      FX_HEADER_SIZE    = 16;
+const int      FX_SEGMENT_SIZE   = 16;
+const int      FX_KEYFRAME_SIZE  = 8;
+const int      FX_TRAILER_SIZE   = 16;
+const uint32_t FX_END_MARKER     = 0xdeadbeef;
+
+// Segment types
+const uint8_t FX_SOLID    = 0x00; // colorA on every pixel
+const uint8_t FX_FADE     = 0x01; // colorA -> colorB over the segment
+const uint8_t FX_CHASE    = 0x02; // run of `width` colorA pixels on colorB, one step per `period` frames
+const uint8_t FX_GRADIENT = 0x03; // colorA at pixel 0 -> colorB at last pixel, scrolls every `period` frames (0 = static)
+const uint8_t FX_STROBE   = 0x04; // colorA for `width` frames out of every `period`, colorB otherwise
+const uint8_t FX_CURVE    = 0x05; // keyframed colour, linear between keys, held outside them
+
+struct FxKeyframe {
+    uint32_t frame;
+    uint8_t rgb[3];
+};
+
+struct FxSegment {
+    uint8_t type;
+    uint8_t width;
+    uint16_t period;
+    uint32_t frames;
+    uint8_t colorA[3];
+    uint8_t colorB[3];
+    uint32_t startFrame;  // absolute frame the segment begins at
+    uint32_t firstKey;    // index into keys for FX_CURVE
+    uint32_t keyCount;
+};
+
+// 16.16 weight blend of two channel values, w in [0, 65536]
+inline uint8_t fxLerp(uint8_t a, uint8_t b, uint32_t w) {
+    return static_cast<uint8_t>((a * (65536u - w) + b * w) >> 16);
+}
+
+// Procedural show: a handful of segments rendered into RGB frames on demand
+class FxTrack {
+public:
+    FxTrack();
+
+    bool load(const std::string& path);
+    uint32_t frameCount() const { return _frameCount; }
+
+    // Render frame `index` for `pixelCount` pixels into out (pixelCount * 3 bytes)
+    void render(uint32_t index, uint8_t* out, int pixelCount) const;
+
+private:
+    std::vector<FxSegment> segments;
+    std::vector<FxKeyframe> keys;
+    uint32_t _frameCount;
+
+    const FxSegment* findSegment(uint32_t index) const;
+    void renderCurve(const FxSegment& seg, uint32_t t, uint8_t rgb[3]) const;
+};
+
+#endif // FX_TRACK_H
@@ -1,9 +1,18 @@
 #include "PCA9635_RPI.h"
+#include "AsyncLog.h"
+#include "Trace.h"
 #include <iostream>
 
 PCA9635::PCA9635(uint8_t address) {
     _i2cAddr = address;
     i2c_fd = -1;
+    _transport = nullptr;
+}
+
+PCA9635::PCA9635(uint8_t address, I2CTransport* transport) {
+    _i2cAddr = address;
+    i2c_fd = -1;
+    _transport = transport;
 }
 
 PCA9635::~PCA9635() {
@@ -15,14 +24,17 @@ PCA9635::~PCA9635() {
 bool PCA9635::begin() {
     const char *filename = "/dev/i2c-1";
 
-    if ((i2c_fd = open(filename, O_RDWR)) < 0) {
-        perror("Failed to open I2C bus");
-        return false;
-    }
-
-    if (ioctl(i2c_fd, I2C_SLAVE, _i2cAddr) < 0) {
-        perror("Failed to connect to I2C device");
-        return false;
+    // A provided transport is already connected
+    if (!_transport) {
+        if ((i2c_fd = open(filename, O_RDWR)) < 0) {
+            perror("Failed to open I2C bus");
+            return false;
+        }
+
+        if (ioctl(i2c_fd, I2C_SLAVE, _i2cAddr) < 0) {
+            perror("Failed to connect to I2C device");
+            return false;
+        }
     }
 
     // MODE1 - normal mode
@@ -50,23 +62,28 @@ bool PCA9635::begin() {
 }
 
 bool PCA9635::setRegister(uint8_t regAddr, uint8_t value) {
+    TRACE_SCOPE("i2c_write", (_i2cAddr << 8) | regAddr);
     uint8_t buf[2] = {regAddr, value};
-    if (write(i2c_fd, buf, 2) != 2) {
-        perror("I2C Write failed");
+    int written = _transport ? _transport->write(_i2cAddr, buf, 2) : write(i2c_fd, buf, 2);
+    if (written != 2) {
+        LOG_ERRNO("I2C Write failed (addr=0x%02llx reg=0x%02llx)", _i2cAddr, regAddr);
         return false;
     }
     return true;
 }
 
 uint8_t PCA9635::getRegister(uint8_t regAddr) {
-    if (write(i2c_fd, &regAddr, 1) != 1) {
-        perror("I2C Read (write phase) failed");
+    TRACE_SCOPE("i2c_read", (_i2cAddr << 8) | regAddr);
+    int written = _transport ? _transport->write(_i2cAddr, &regAddr, 1) : write(i2c_fd, &regAddr, 1);
+    if (written != 1) {
+        LOG_ERRNO("I2C Read (write phase) failed (addr=0x%02llx reg=0x%02llx)", _i2cAddr, regAddr);
         return 0;
     }
 
     uint8_t data;
-    if (read(i2c_fd, &data, 1) != 1) {
-        perror("I2C Read (read phase) failed");
+    int got = _transport ? _transport->read(_i2cAddr, &data, 1) : read(i2c_fd, &data, 1);
+    if (got != 1) {
+        LOG_ERRNO("I2C Read (read phase) failed (addr=0x%02llx reg=0x%02llx)", _i2cAddr, regAddr);
         return 0;
     }
 
@@ -100,6 +117,7 @@ void PCA9635::setLEDState(uint8_t ledNum, uint8_t state) {
 
 void PCA9635::setLEDPWM(uint8_t ledNum, uint8_t pwm) {
     if (ledNum > 15) return;
+    TRACE_SCOPE("pca_set_pwm", (_i2cAddr << 8) | ledNum);
     updateLEDOUTRegister(ledNum, PCA9635_LED_PWM);
     setRegister(PCA9635_PWM0 + ledNum, pwm);
 }
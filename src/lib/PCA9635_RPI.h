@@ -31,9 +31,19 @@ const uint8_t PCA9635_LED_ON    = 0x01;
 const uint8_t PCA9635_LED_PWM   = 0x02;
 const uint8_t PCA9635_LED_GROUP = 0x03;
 
+// Replaces /dev/i2c-1 when set, e.g. by the swarm simulator's virtual buses.
+// Both calls return the number of bytes transferred, like write()/read().
+class I2CTransport {
+public:
+    virtual ~I2CTransport() {}
+    virtual int write(uint8_t addr, const uint8_t* buf, int len) = 0;
+    virtual int read(uint8_t addr, uint8_t* buf, int len) = 0;
+};
+
 class PCA9635 {
 public:
     PCA9635(uint8_t address);
+    PCA9635(uint8_t address, I2CTransport* transport);
     ~PCA9635();
 
     bool begin();
@@ -51,6 +61,7 @@ public:
 private:
     int i2c_fd;
     uint8_t _i2cAddr;
+    I2CTransport* _transport;
     void updateLEDOUTRegister(uint8_t ledNum, uint8_t state);
 };
 
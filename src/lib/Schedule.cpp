@@ -0,0 +1,60 @@
+#include "Schedule.h"
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+std::chrono::system_clock::time_point parseCompactTime(const std::string& compactTimeStr) {
+    std::tm tm = {};
+    if (compactTimeStr.size() != 14) {
+        throw std::runtime_error("잘못된 시간형식입니다. 20250525180000 형식 유지");
+    }
+
+    tm.tm_year = std::stoi(compactTimeStr.substr(0, 4)) - 1900;
+    tm.tm_mon  = std::stoi(compactTimeStr.substr(4, 2)) - 1;
+    tm.tm_mday = std::stoi(compactTimeStr.substr(6, 2));
+    tm.tm_hour = std::stoi(compactTimeStr.substr(8, 2));
+    tm.tm_min  = std::stoi(compactTimeStr.substr(10, 2));
+    tm.tm_sec  = std::stoi(compactTimeStr.substr(12, 2));
+
+    return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+}
+
+std::vector<ScheduleEntry> loadSchedule(const std::string& jsonPath) {
+    std::ifstream f(jsonPath);
+    nlohmann::json j;
+    f >> j;
+
+    std::vector<ScheduleEntry> schedule;
+    for (auto& item : j) {
+        ScheduleEntry entry;
+        entry.filename = item["filename"];
+        entry.hasTime = item.contains("time");
+        if (entry.hasTime) entry.playTime = parseCompactTime(item["time"]);
+        entry.loops = item.value("loop", 1);
+        entry.crossfade = item.value("crossfade", 0);
+        schedule.push_back(entry);
+    }
+    return schedule;
+}
+
+std::chrono::system_clock::time_point scheduleOrigin(const std::vector<ScheduleEntry>& schedule,
+                                                     std::chrono::system_clock::time_point now) {
+    if (!schedule.empty() && schedule[0].hasTime && schedule[0].playTime > now) {
+        return schedule[0].playTime;
+    }
+    return now;
+}
+
+void layoutSchedule(Timeline& timeline, const std::vector<ScheduleEntry>& schedule,
+                    const std::map<std::string, ShowTrack>& tracks,
+                    std::chrono::system_clock::time_point origin) {
+    for (const auto& entry : schedule) {
+        uint64_t earliest = 0;
+        if (entry.hasTime && entry.playTime > origin) {
+            int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(entry.playTime - origin).count();
+            earliest = (ns + FRAME_INTERVAL_NS - 1) / FRAME_INTERVAL_NS;
+        }
+        timeline.append(&tracks.at(entry.filename), entry.loops, entry.crossfade, earliest);
+    }
+}
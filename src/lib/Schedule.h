@@ -0,0 +1,38 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "ShowTrack.h"
+#include "Timeline.h"
+
+struct ScheduleEntry {
+    std::string filename;
+    bool hasTime;         // entries without "time" follow the previous one directly
+    std::chrono::system_clock::time_point playTime;
+    uint32_t loops;
+    uint32_t crossfade;   // frames blended with the end of the previous entry
+};
+
+// "20250525180000" in local time; throws std::runtime_error on a bad length
+std::chrono::system_clock::time_point parseCompactTime(const std::string& compactTimeStr);
+
+// Playlist JSON: [{"filename", optional "time", "loop", "crossfade"}, ...]
+std::vector<ScheduleEntry> loadSchedule(const std::string& jsonPath);
+
+// Wall clock time of timeline frame 0: the first entry's start time, or now
+// if it has none or it has already passed
+std::chrono::system_clock::time_point scheduleOrigin(const std::vector<ScheduleEntry>& schedule,
+                                                     std::chrono::system_clock::time_point now);
+
+// Lays every entry out on one frame clock starting at origin. Timed entries
+// keep their slot; the others follow the previous entry. Every file named in
+// the schedule must be in tracks (probed or loaded).
+void layoutSchedule(Timeline& timeline, const std::vector<ScheduleEntry>& schedule,
+                    const std::map<std::string, ShowTrack>& tracks,
+                    std::chrono::system_clock::time_point origin);
+
+#endif // SCHEDULE_H
@@ -0,0 +1,112 @@
+#include "ShowTrack.h"
+#include <fstream>
+#include <iostream>
+
+bool isFxFile(const std::string& filename) {
+    return filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".fx") == 0;
+}
+
+ShowTrack::ShowTrack() : loaded(false) {
+    store = nullptr;
+    procedural = false;
+    probed = false;
+    _frameSize = 0;
+    _frameCount = 0;
+}
+
+ShowTrack::~ShowTrack() {
+    releaseFrames();
+}
+
+void ShowTrack::releaseFrames() {
+    for (FrameId id : frames) store->release(id);
+    frames.clear();
+}
+
+bool ShowTrack::probe(const std::string& path, int frameSize) {
+    if (isFxFile(path)) return load(path, frameSize);
+
+    std::ifstream bin(path, std::ios::binary | std::ios::ate);
+    if (!bin) {
+        std::cerr << "[ERROR] Cannot open file: " << path << "\n";
+        return false;
+    }
+    std::streamoff size = bin.tellg();
+    _frameSize = frameSize;
+    _frameCount = size > BIN_HEADER_SIZE ? (size - BIN_HEADER_SIZE) / frameSize : 0;
+    procedural = false;
+    probed = true;
+    return true;
+}
+
+bool ShowTrack::load(const std::string& path, int frameSize) {
+    _frameSize = frameSize;
+    releaseFrames();
+
+    if (isFxFile(path)) {
+        procedural = true;
+        if (fx.load(path)) {
+            _frameCount = fx.frameCount();
+            loaded.store(true, std::memory_order_release);
+            return true;
+        }
+        // Leave an empty track behind rather than a half-parsed one
+        fx = FxTrack();
+        procedural = false;
+        return false;
+    }
+
+    procedural = false;
+    std::ifstream bin(path, std::ios::binary);
+    if (!bin) {
+        std::cerr << "[ERROR] Cannot open file: " << path << "\n";
+        return false;
+    }
+
+    // Read in blocks and intern each frame; frames already held by another
+    // track cost a hash and a compare, no allocation
+    store = &FrameStore::shared(frameSize);
+    const int BLOCK_FRAMES = 1024;
+    std::vector<uint8_t> block(static_cast<size_t>(BLOCK_FRAMES) * frameSize);
+    bin.seekg(BIN_HEADER_SIZE, std::ios::beg);
+    while (bin) {
+        bin.read(reinterpret_cast<char*>(block.data()), block.size());
+        int count = bin.gcount() / frameSize;
+        for (int i = 0; i < count; ++i) {
+            FrameId id = store->intern(block.data() + static_cast<size_t>(i) * frameSize);
+            if (id == FRAME_ID_NONE) {
+                releaseFrames();
+                return false;
+            }
+            frames.push_back(id);
+        }
+    }
+
+    // A probed track is already laid out on a timeline; keep its length even
+    // if the file changed in between
+    if (probed) {
+        std::vector<uint8_t> black(frameSize, 0);
+        while (frames.size() < _frameCount) {
+            FrameId id = store->intern(black.data());
+            if (id == FRAME_ID_NONE) {
+                releaseFrames();
+                return false;
+            }
+            frames.push_back(id);
+        }
+        while (frames.size() > _frameCount) {
+            store->release(frames.back());
+            frames.pop_back();
+        }
+    } else {
+        _frameCount = frames.size();
+    }
+    loaded.store(true, std::memory_order_release);
+    return true;
+}
+
+const uint8_t* ShowTrack::frame(uint32_t index, uint8_t* scratch) const {
+    if (!procedural) return store->data(frames[index]);
+    fx.render(index, scratch, _frameSize / 3);
+    return scratch;
+}
@@ -0,0 +1,53 @@
+#ifndef SHOW_TRACK_H
+#define SHOW_TRACK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include "FxTrack.h"
+#include "FrameStore.h"
+
+const int BIN_HEADER_SIZE = 32;
+
+// True for effect tracks (*.fx), false for raw frame dumps (*.bin)
+bool isFxFile(const std::string& filename);
+
+// One playlist entry's frames: either a raw .bin dump or an effect track
+// rendered at playback time. Both are addressed by frame index. Raw frames
+// are interned in the shared FrameStore, so a track is a list of frame ids
+// and frames repeated within or across tracks are stored once.
+class ShowTrack {
+public:
+    ShowTrack();
+    ~ShowTrack();
+
+    // Dispatches on the file extension
+    bool load(const std::string& path, int frameSize);
+    // Learns the frame count without reading the frames (effect tracks are
+    // small and fully loaded). load() may then run on another thread while
+    // this track already sits on a timeline; check isLoaded() before frame().
+    bool probe(const std::string& path, int frameSize);
+
+    uint32_t frameCount() const { return _frameCount; }
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+    bool isProcedural() const { return procedural; }
+
+    // Pointer to frame `index`. Raw frames are returned in place; effect
+    // frames are rendered into scratch (frameSize bytes) and scratch is returned.
+    const uint8_t* frame(uint32_t index, uint8_t* scratch) const;
+
+private:
+    void releaseFrames();
+
+    std::vector<FrameId> frames;
+    FrameStore* store;
+    FxTrack fx;
+    bool procedural;
+    bool probed;
+    int _frameSize;
+    uint32_t _frameCount;
+    std::atomic<bool> loaded;
+};
+
+#endif // SHOW_TRACK_H
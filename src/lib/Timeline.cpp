@@ -0,0 +1,97 @@
+#include "Timeline.h"
+#include <algorithm>
+
+const int64_t NSEC_PER_SEC = 1000000000;
+
+struct timespec timespecAddNs(const struct timespec& t, int64_t ns) {
+    int64_t total = static_cast<int64_t>(t.tv_sec) * NSEC_PER_SEC + t.tv_nsec + ns;
+    struct timespec r;
+    r.tv_sec = total / NSEC_PER_SEC;
+    r.tv_nsec = total % NSEC_PER_SEC;
+    if (r.tv_nsec < 0) {
+        r.tv_sec -= 1;
+        r.tv_nsec += NSEC_PER_SEC;
+    }
+    return r;
+}
+
+struct timespec frameDeadline(const struct timespec& anchor, uint64_t frame) {
+    return timespecAddNs(anchor, static_cast<int64_t>(frame) * FRAME_INTERVAL_NS);
+}
+
+struct timespec anchorForFrame(const struct timespec& now, uint64_t frame) {
+    return timespecAddNs(now, -static_cast<int64_t>(frame) * FRAME_INTERVAL_NS);
+}
+
+Timeline::Timeline(int frameSize)
+    : _frameSize(frameSize), playStart(0), scratchOut(frameSize), scratchIn(frameSize), mixBuf(frameSize) {
+}
+
+void Timeline::append(const ShowTrack* track, uint32_t loops, uint32_t crossfade, uint64_t earliestFrame) {
+    TimelineEntry e;
+    e.track = track;
+    e.loops = loops ? loops : 1;
+    e.crossfade = 0;
+
+    const uint64_t length = static_cast<uint64_t>(track->frameCount()) * e.loops;
+    uint64_t start = earliestFrame;
+
+    if (!entries.empty()) {
+        const TimelineEntry& prev = entries.back();
+        uint64_t overlap = std::min<uint64_t>({crossfade, prev.endFrame - prev.startFrame, length});
+        start = std::max(start, prev.endFrame - overlap);
+        if (entries.size() >= 2) start = std::max(start, entries[entries.size() - 2].endFrame);
+        if (start < prev.endFrame) e.crossfade = prev.endFrame - start;
+    }
+
+    e.startFrame = start;
+    e.endFrame = start + length;
+    entries.push_back(e);
+}
+
+int Timeline::entryAt(uint64_t frame) const {
+    auto it = std::upper_bound(entries.begin(), entries.end(), frame,
+        [](uint64_t f, const TimelineEntry& e) { return f < e.startFrame; });
+    int last = static_cast<int>(it - entries.begin()) - 1;
+
+    // Only neighbours can overlap; skipping back over an empty entry is enough
+    for (int i = last; i >= 0 && i >= last - 2; --i) {
+        if (frame < entries[i].endFrame) return i;
+    }
+    return -1;
+}
+
+uint64_t Timeline::nextActiveFrame(uint64_t frame) const {
+    if (entryAt(frame) >= 0) return frame;
+    for (const auto& e : entries) {
+        if (e.startFrame > frame && e.endFrame > e.startFrame) return e.startFrame;
+    }
+    return endFrame();
+}
+
+const uint8_t* Timeline::entryFrame(const TimelineEntry& e, uint64_t frame, uint8_t* scratch) const {
+    if (!e.track->isLoaded()) return nullptr;
+    uint32_t local = (frame - e.startFrame) % e.track->frameCount();
+    return e.track->frame(local, scratch);
+}
+
+const uint8_t* Timeline::frame(uint64_t frame) {
+    int i = entryAt(frame);
+    if (i < 0) return nullptr;
+
+    const TimelineEntry& cur = entries[i];
+    const uint8_t* in = entryFrame(cur, frame, scratchIn.data());
+    if (i == 0 || frame >= entries[i - 1].endFrame) return in;
+
+    // Playback started at this entry, after the previous one began: nothing to fade out of
+    const TimelineEntry& prev = entries[i - 1];
+    if (playStart >= cur.startFrame && prev.startFrame < playStart) return in;
+
+    // Crossfade: weight steps from 1/(n+1) to n/(n+1) across the n overlapped frames
+    const uint8_t* out = entryFrame(prev, frame, scratchOut.data());
+    if (!out || !in) return in ? in : out;
+    uint32_t k = frame - cur.startFrame;
+    uint32_t w = ((k + 1) << 16) / (cur.crossfade + 1);
+    for (int n = 0; n < _frameSize; ++n) mixBuf[n] = fxLerp(out[n], in[n], w);
+    return mixBuf.data();
+}
@@ -0,0 +1,70 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#include "ShowTrack.h"
+
+const int64_t FRAME_INTERVAL_NS = 30'000'000;
+
+struct timespec timespecAddNs(const struct timespec& t, int64_t ns);
+
+// Monotonic deadline of timeline frame `frame` for a clock whose frame 0 is at anchor
+struct timespec frameDeadline(const struct timespec& anchor, uint64_t frame);
+
+// Anchor that puts timeline frame `frame` at `now`
+struct timespec anchorForFrame(const struct timespec& now, uint64_t frame);
+
+struct TimelineEntry {
+    const ShowTrack* track;
+    uint32_t loops;
+    uint32_t crossfade;   // frames actually overlapped with the previous entry
+    uint64_t startFrame;
+    uint64_t endFrame;
+};
+
+// All playlist entries laid out on one frame clock. Entries run back to back
+// unless scheduled later (which leaves a dark gap), and an entry with a
+// crossfade starts that many frames before the previous one ends.
+class Timeline {
+public:
+    Timeline(int frameSize);
+
+    // earliestFrame is the scheduled start; an entry is never started before the
+    // previous one ends minus its crossfade. At most two entries ever overlap.
+    void append(const ShowTrack* track, uint32_t loops, uint32_t crossfade, uint64_t earliestFrame = 0);
+
+    size_t entryCount() const { return entries.size(); }
+    const TimelineEntry& entry(size_t i) const { return entries[i]; }
+    uint64_t endFrame() const { return entries.empty() ? 0 : entries.back().endFrame; }
+
+    // Entry playing at frame (the incoming one during a crossfade), -1 in a gap or past the end
+    int entryAt(uint64_t frame) const;
+    // First frame >= frame that belongs to an entry, endFrame() if none
+    uint64_t nextActiveFrame(uint64_t frame) const;
+    // Frame to show after `frame`: the next one, or from a gap straight to the next entry
+    uint64_t nextFrame(uint64_t frame) const { return entryAt(frame) >= 0 ? frame + 1 : nextActiveFrame(frame); }
+
+    // Frame data for timeline frame, blended during crossfades.
+    // Returns nullptr in gaps and while the entry's track is still loading.
+    // The pointer stays valid until the next call.
+    const uint8_t* frame(uint64_t frame);
+
+    // Where playback was started from. An entry that starts there plays its
+    // crossfade frames on their own instead of blending in the previous entry,
+    // which was never shown. Defaults to 0 (the whole timeline).
+    void startAt(uint64_t frame) { playStart = frame; }
+
+private:
+    std::vector<TimelineEntry> entries;
+    int _frameSize;
+    uint64_t playStart;
+    std::vector<uint8_t> scratchOut;
+    std::vector<uint8_t> scratchIn;
+    std::vector<uint8_t> mixBuf;
+
+    const uint8_t* entryFrame(const TimelineEntry& e, uint64_t frame, uint8_t* scratch) const;
+};
+
+#endif // TIMELINE_H
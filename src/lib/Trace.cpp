@@ -0,0 +1,125 @@
+#include "Trace.h"
+
+#ifdef PIDRONE_TRACE
+
+#include "EventSignal.h"
+#include <stdio.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+const int64_t TRACE_INSTANT_DUR = -1;
+
+struct TraceEvent {
+    std::atomic<const char*> name;   // published last; nullptr while being written
+    uint32_t tid;
+    int64_t startNs;
+    int64_t durNs;
+    int64_t arg;
+};
+
+static TraceEvent events[TRACE_RING_SIZE];
+static std::atomic<uint64_t> nextEvent(0);
+static thread_local uint32_t threadId = 0;
+
+static std::string dumpPath = "trace.json";
+static std::mutex dumpMutex;
+static EventSignal dumpEvent;
+
+int64_t traceNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int64_t traceLateNs(const struct timespec& deadline) {
+    return traceNowNs() - (static_cast<int64_t>(deadline.tv_sec) * 1000000000 + deadline.tv_nsec);
+}
+
+static void record(const char* name, int64_t startNs, int64_t durNs, int64_t arg) {
+    if (threadId == 0) threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+
+    TraceEvent& ev = events[nextEvent.fetch_add(1, std::memory_order_relaxed) & (TRACE_RING_SIZE - 1)];
+    ev.name.store(nullptr, std::memory_order_relaxed);
+    ev.tid = threadId;
+    ev.startNs = startNs;
+    ev.durNs = durNs;
+    ev.arg = arg;
+    ev.name.store(name, std::memory_order_release);
+}
+
+TraceScope::TraceScope(const char* name, int64_t arg) {
+    _name = name;
+    _arg = arg;
+    _startNs = traceNowNs();
+}
+
+TraceScope::~TraceScope() {
+    record(_name, _startNs, traceNowNs() - _startNs, _arg);
+}
+
+void traceInstant(const char* name, int64_t arg) {
+    record(name, traceNowNs(), TRACE_INSTANT_DUR, arg);
+}
+
+// Events written while the dump runs may come out torn; the ring is not paused
+void traceDump() {
+    std::lock_guard<std::mutex> lock(dumpMutex);
+    FILE* out = fopen(dumpPath.c_str(), "w");
+    if (!out) {
+        perror("Failed to open trace file");
+        return;
+    }
+
+    uint64_t end = nextEvent.load();
+    uint64_t begin = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+    int pid = getpid();
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (uint64_t i = begin; i < end; ++i) {
+        const TraceEvent& ev = events[i & (TRACE_RING_SIZE - 1)];
+        const char* name = ev.name.load(std::memory_order_acquire);
+        if (!name) continue;
+
+        fprintf(out, "%s{\"name\":\"%s\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,",
+                first ? "" : ",\n", name, pid, ev.tid, ev.startNs / 1000.0);
+        if (ev.durNs == TRACE_INSTANT_DUR) fprintf(out, "\"ph\":\"i\",\"s\":\"t\",");
+        else fprintf(out, "\"ph\":\"X\",\"dur\":%.3f,", ev.durNs / 1000.0);
+        fprintf(out, "\"args\":{\"arg\":%lld}}", static_cast<long long>(ev.arg));
+        first = false;
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    fprintf(stderr, "[TRACE] %llu events written to %s\n",
+            static_cast<unsigned long long>(end - begin), dumpPath.c_str());
+}
+
+void traceDumpOnSignal(int) {
+    dumpEvent.notify();
+}
+
+static void dumperLoop() {
+    // Inherited chrt priority would let the file writes compete with the frame loop
+    struct sched_param param = {};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+
+    while (true) {
+        dumpEvent.wait();
+        traceDump();
+    }
+}
+
+void traceInit(const char* path) {
+    dumpPath = path;
+    std::thread(dumperLoop).detach();
+    signal(SIGUSR1, traceDumpOnSignal);
+}
+
+#endif // PIDRONE_TRACE
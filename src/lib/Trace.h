@@ -0,0 +1,62 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Pipeline tracing, compiled in only with -DPIDRONE_TRACE (TRACE=1 ./build.sh).
+// Spans and instants go into a preallocated ring shared by all threads; the
+// ring is written out as Chrome trace-event JSON (open in ui.perfetto.dev)
+// on SIGUSR1 and at exit. Without the flag every TRACE_* macro expands to
+// nothing, arguments included.
+
+#ifdef PIDRONE_TRACE
+
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE (1 << 17)   // events, power of two; ~20 s of playback
+#endif
+
+int64_t traceNowNs();
+
+class TraceScope {
+public:
+    TraceScope(const char* name, int64_t arg);
+    ~TraceScope();
+
+private:
+    const char* _name;
+    int64_t _arg;
+    int64_t _startNs;
+};
+
+void traceInstant(const char* name, int64_t arg);
+
+// How late the caller is relative to a CLOCK_MONOTONIC deadline
+int64_t traceLateNs(const struct timespec& deadline);
+
+// Sets the dump path and installs the SIGUSR1 handler
+void traceInit(const char* path);
+void traceDump();
+// The SIGUSR1 handler. gpioInitialise() takes over every signal, so pigpio
+// programs hand it to gpioSetSignalFunc() afterwards (TRACE_PIGPIO_SIGNAL).
+void traceDumpOnSignal(int signum);
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name, arg) TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name, (int64_t)(arg))
+#define TRACE_INSTANT(name, arg) traceInstant(name, (int64_t)(arg))
+#define TRACE_INIT(path) traceInit(path)
+#define TRACE_DUMP() traceDump()
+#define TRACE_PIGPIO_SIGNAL() gpioSetSignalFunc(SIGUSR1, traceDumpOnSignal)
+
+#else
+
+#define TRACE_SCOPE(name, arg) do {} while (0)
+#define TRACE_INSTANT(name, arg) do {} while (0)
+#define TRACE_INIT(path) do {} while (0)
+#define TRACE_DUMP() do {} while (0)
+#define TRACE_PIGPIO_SIGNAL() do {} while (0)
+
+#endif // PIDRONE_TRACE
+
+#endif // TRACE_H
@@ -100,10 +100,10 @@ def run_led_async(filename):
             print("[Pi] LED error:", e)
     threading.Thread(target=worker, daemon=True).start()
 
-# Send list of stored .bin files to ESP32
+# Send list of stored show files (.bin / .fx) to ESP32
 def list_files():
     try:
-        files = [f for f in os.listdir(SAVE_DIR) if f.endswith(".bin")]
+        files = [f for f in os.listdir(SAVE_DIR) if f.endswith((".bin", ".fx"))]
         response = json.dumps(files)
         ser.write(f"{response}\n".encode())
         print("[Pi] Sent file list to ESP32.")
@@ -8,55 +8,29 @@
 #include <csignal>
 #include <iomanip>
 #include <sstream>
-#include <nlohmann/json.hpp>
+#include <cstring>
 #include "./lib/PCA9635_RPI.h"
+#include "./lib/ShowTrack.h"
+#include "./lib/Timeline.h"
+#include "./lib/Schedule.h"
+#include "./lib/DroneLeds.h"
+#include "./lib/AsyncLog.h"
+#include "./lib/Trace.h"
+#include "./lib/Checkpoint.h"
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
 
 
 // Initialize PCA9635 boards with I2C addresses
 PCA9635 pca1(0x40);
 PCA9635 pca2(0x41);
 PCA9635 pca3(0x42);
+DroneLeds leds(pca1, pca2, pca3);
 
-std::map<std::string, std::vector<std::vector<uint8_t>>> binDataMap;
-
-struct ScheduleEntry {
-    std::string filename;
-    std::chrono::system_clock::time_point playTime;
-};
-
-// Define LED control structures
-struct Channel {
-    PCA9635* pca;
-    int ch;
-};
-
-struct RGBChannel {
-    Channel r, g, b;
-};
-
-// Map LED index (0~15) to the corresponding RGB PCA9635 channels
-RGBChannel getLEDChannel(int ledIndex) {
-    switch (ledIndex) {
-        case 0: return {{&pca1, 0}, {&pca1, 1}, {&pca1, 2}};
-        case 1: return {{&pca1, 3}, {&pca1, 4}, {&pca1, 5}};
-        case 2: return {{&pca1, 6}, {&pca1, 7}, {&pca1, 8}};
-        case 3: return {{&pca1, 9}, {&pca1, 10}, {&pca1, 11}};
-        case 4: return {{&pca1, 12}, {&pca1, 13}, {&pca1, 14}};
-        case 5: return {{&pca1, 15}, {&pca2, 0}, {&pca2, 1}};
-        case 6: return {{&pca2, 2}, {&pca2, 3}, {&pca2, 4}};
-        case 7: return {{&pca2, 5}, {&pca2, 6}, {&pca2, 7}};
-        case 8: return {{&pca2, 8}, {&pca2, 9}, {&pca2, 10}};
-        case 9: return {{&pca2, 11}, {&pca2, 12}, {&pca2, 13}};
-        case 10:return {{&pca2, 14}, {&pca2, 15}, {&pca3, 0}};
-        case 11:return {{&pca3, 1}, {&pca3, 2}, {&pca3, 3}};
-        case 12:return {{&pca3, 4}, {&pca3, 5}, {&pca3, 6}};
-        case 13:return {{&pca3, 7}, {&pca3, 8}, {&pca3, 9}};
-        case 14:return {{&pca3, 10}, {&pca3, 11}, {&pca3, 12}};
-        case 15:return {{&pca3, 13}, {&pca3, 14}, {&pca3, 15}};
-        default:return {{nullptr, -1}, {nullptr, -1}, {nullptr, -1}};
-    }
-}
+std::map<std::string, ShowTrack> trackMap;
+volatile sig_atomic_t exitSignal = 0;
 
 bool fileValidation(std::ifstream& bin , int FRAME_SIZE){
     std::streampos currentPos = bin.tellg();
@@ -120,16 +94,6 @@ bool fileValidation(std::ifstream& bin , int FRAME_SIZE){
     
 }
 
-// Set the color of a specific LED (by index)
-void setLED(int ledIndex, uint8_t r, uint8_t g, uint8_t b) {
-    RGBChannel ch = getLEDChannel(ledIndex);
-    int r_fixed = r * 2/3 ;
-    int b_fixed = b * 2/3 ;
-    if (ch.r.pca && ch.r.ch >= 0) ch.r.pca->analogWrite(ch.r.ch, r_fixed);
-    if (ch.g.pca && ch.g.ch >= 0) ch.g.pca->analogWrite(ch.g.ch, g);
-    if (ch.b.pca && ch.b.ch >= 0) ch.b.pca->analogWrite(ch.b.ch, b_fixed);
-}
-
 // Print the current RGB frame visually to the terminal (as color blocks)
 void printFrameVisual(const std::vector<uint8_t>& frame) {
     std::cout << "Current Frame (4x4 RGB):\n";
@@ -146,61 +110,34 @@ void printFrameVisual(const std::vector<uint8_t>& frame) {
     std::cout << std::endl;
 }
 
-std::chrono::system_clock::time_point parseCompactTime(const std::string& compactTimeStr) {
-    std::tm tm = {};
-    if (compactTimeStr.size() != 14) {
-        throw std::runtime_error("잘못된 시간형식입니다. 20250525180000 형식 유지");
-    }
-
-    tm.tm_year = std::stoi(compactTimeStr.substr(0, 4)) - 1900; 
-    tm.tm_mon  = std::stoi(compactTimeStr.substr(4, 2)) - 1;    
-    tm.tm_mday = std::stoi(compactTimeStr.substr(6, 2));
-    tm.tm_hour = std::stoi(compactTimeStr.substr(8, 2));
-    tm.tm_min  = std::stoi(compactTimeStr.substr(10, 2));
-    tm.tm_sec  = std::stoi(compactTimeStr.substr(12, 2));
-
-    return std::chrono::system_clock::from_time_t(std::mktime(&tm));
-}
-
-bool loadBinFile(const std::string& path, const std::string& filename, int frameSize) {
-    std::ifstream bin(path + filename, std::ios::binary);
-    if (!bin) {
-        std::cerr << "[ERROR] Cannot open file: " << filename << "\n";
+bool probeTrackFile(const std::string& path, const std::string& filename, int frameSize) {
+    if (!trackMap[filename].probe(path + filename, frameSize)) {
+        trackMap.erase(filename);
         return false;
     }
-
-    std::vector<std::vector<uint8_t>> frames;
-    bin.seekg(32, std::ios::beg);
-    while (true) {
-        std::vector<uint8_t> frame(frameSize);
-        bin.read(reinterpret_cast<char*>(frame.data()), frameSize);
-        if (bin.gcount() != frameSize) break;
-        frames.push_back(frame);
-    }
-    binDataMap[filename] = std::move(frames);
     return true;
 }
 
-std::vector<ScheduleEntry> loadSchedule(const std::string& jsonPath) {
-    std::ifstream f(jsonPath);
-    nlohmann::json j;
-    f >> j;
-
-    std::vector<ScheduleEntry> schedule;
-    for (auto& item : j) {
-        schedule.push_back({ item["filename"], parseCompactTime(item["time"]) });
-    }
-    return schedule;
+// Timeline frames elapsed between anchor and now (negative before the anchor)
+int64_t framesSince(const struct timespec& anchor, const struct timespec& now) {
+    int64_t ns = (static_cast<int64_t>(now.tv_sec) - anchor.tv_sec) * 1000000000 + (now.tv_nsec - anchor.tv_nsec);
+    return ns >= 0 ? (ns + FRAME_INTERVAL_NS - 1) / FRAME_INTERVAL_NS : ns / FRAME_INTERVAL_NS;
 }
 
-
-// Handle SIGINT and SIGTERM: turn off all LEDs before exit
+// SIGINT and SIGTERM: the main thread turns off the LEDs and exits; the
+// handler only records the signal, which also cuts its sleep short
 void handleExit(int signum) {
-    std::cout << "\n[강제종료] " << std::endl;
-    for (int i = 0 ; i < 16; ++i) {
-        setLED(i, 0, 0, 0);
-    }
-    exit(0);
+    exitSignal = signum;
+}
+
+// Threads inherit the creator's signal mask. Helper threads are started with
+// SIGINT/SIGTERM blocked so the signals always land on the main thread.
+void blockExitSignals(bool block) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(block ? SIG_BLOCK : SIG_UNBLOCK, &set, nullptr);
 }
 
 int main(int argc, char* argv[]) {
@@ -217,6 +154,11 @@ int main(int argc, char* argv[]) {
     int dronePixel = std::stoi(argv[2]); // Convert string to integer
     int frameSize = dronePixel * dronePixel * 3;
 
+    blockExitSignals(true);
+    asyncLogStart();
+    TRACE_INIT("./rpi_play_trace.json");
+    blockExitSignals(false);
+
     // Register signal handlers for safe exit
     signal(SIGINT, handleExit);
     signal(SIGTERM, handleExit);
@@ -224,48 +166,155 @@ int main(int argc, char* argv[]) {
     // Initialize all PCA9635 boards
     if (!pca1.begin() || !pca2.begin() || !pca3.begin()) {
         std::cerr << "Failed to initialize PCA9635 boards.\n";
+        asyncLogFlush();   // the driver's queued errors say why
         return 1;
     }
     
     auto schedule = loadSchedule(scheduleName);
+    if (schedule.empty()) {
+        asyncLogFlush();
+        return 0;
+    }
+
+    // Only frame counts are needed to lay out the timeline; frames are read below
     for (const auto& entry : schedule) {
-        if (binDataMap.find(entry.filename) == binDataMap.end()) {
-            if (!loadBinFile(binFilePath, entry.filename, frameSize)) {
+        if (trackMap.find(entry.filename) == trackMap.end()) {
+            if (!probeTrackFile(binFilePath, entry.filename, frameSize)) {
+                asyncLogFlush();
                 return 1;
             }
         }
     }
 
-    for (const auto& entry : schedule) {
-        auto now = std::chrono::system_clock::now();
-        if (entry.playTime > now) {
-            std::this_thread::sleep_until(entry.playTime);
+    auto sysNow = std::chrono::system_clock::now();
+    struct timespec monoNow;
+    clock_gettime(CLOCK_MONOTONIC, &monoNow);
+
+    // A run of the same playlist that was cut short (crash, SIGTERM) and would
+    // still be playing now is rejoined on its own clock instead of restarted
+    std::ifstream playlistFile(scheduleName);
+    std::stringstream playlistText;
+    playlistText << playlistFile.rdbuf();
+    const uint64_t playlistHash = checkpointHash(playlistText.str(), frameSize);
+
+    Checkpoint checkpoint;
+    checkpoint.open(CHECKPOINT_PATH);
+    CheckpointState saved;
+    bool resume = checkpoint.read(saved) && saved.playlistHash == playlistHash &&
+                  framesSince(saved.anchor, monoNow) < static_cast<int64_t>(saved.endFrame);
+
+    // A fresh start reads every track before frame 0, so the show never plays
+    // dark waiting on disk, and only then reads the clocks: an origin of "now"
+    // must not leave the frames due during loading to be rushed out. A resume
+    // is already late: it keeps its clock, reads what plays first (both sides
+    // of a crossfade) now and the rest on a background thread.
+    auto loadEntry = [&](int i) {
+        if (i < 0 || trackMap[schedule[i].filename].isLoaded()) return true;
+        TRACE_SCOPE("load_track", i);
+        return trackMap[schedule[i].filename].load(binFilePath + schedule[i].filename, frameSize);
+    };
+
+    if (!resume) {
+        for (size_t i = 0; i < schedule.size(); ++i) {
+            if (!loadEntry(i)) {
+                asyncLogFlush();
+                return 1;
+            }
         }
+        sysNow = std::chrono::system_clock::now();
+        clock_gettime(CLOCK_MONOTONIC, &monoNow);
+    }
 
-        const auto& frames = binDataMap[entry.filename];
-        
-        const int interval_us = 30'000;
-        struct timespec nextFrameTime;
-        clock_gettime(CLOCK_MONOTONIC, &nextFrameTime);
-        
-        for (const auto& frame : frames) {
-            for (int i = 0; i < dronePixel * dronePixel; ++i) {
-                setLED(i, frame[i * 3 + 0], frame[i * 3 + 1], frame[i * 3 + 2]);
-            }
+    // Lay every entry out on one frame clock. Frame 0 is the first entry's start
+    // time, or now if that has already passed; later timed entries keep their slot.
+    Timeline timeline(frameSize);
+    auto origin = scheduleOrigin(schedule, sysNow);
+    if (resume) {
+        origin = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(saved.originNs)));
+    }
+    layoutSchedule(timeline, schedule, trackMap, origin);
+
+    const struct timespec anchor = resume ? saved.anchor : timespecAddNs(monoNow,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(origin - sysNow).count());
+
+    CheckpointState state;
+    state.playlistHash = playlistHash;
+    state.originNs = std::chrono::duration_cast<std::chrono::nanoseconds>(origin.time_since_epoch()).count();
+    state.anchor = anchor;
+    state.endFrame = timeline.endFrame();
+    state.entry = 0;
+    state.frame = 0;
+    checkpoint.begin(state);
+
+    uint64_t f = timeline.nextActiveFrame(resume ? std::max<int64_t>(framesSince(anchor, monoNow), 0) : 0);
+    int firstEntry = timeline.entryAt(f);
+
+    std::vector<std::pair<ShowTrack*, std::string>> pending;
+    if (resume) {
+        loadEntry(firstEntry);
+        if (firstEntry > 0) loadEntry(firstEntry - 1);
+        for (size_t i = std::max(firstEntry, 0); i < schedule.size(); ++i) {
+            pending.push_back({ &trackMap[schedule[i].filename], binFilePath + schedule[i].filename });
+        }
+    }
 
-            nextFrameTime.tv_nsec += interval_us * 1000;
-            if (nextFrameTime.tv_nsec >= 1000000000) {
-                nextFrameTime.tv_sec += 1;
-                nextFrameTime.tv_nsec -= 1000000000;
-            }
-            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextFrameTime, nullptr);
+    blockExitSignals(true);
+    std::thread loader([&]() {
+        // Disk reads and allocation stay below the frame loop's chrt priority
+        struct sched_param param = {};
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+
+        // The main thread joins this before exiting; stop between tracks on a signal
+        for (const auto& item : pending) {
+            if (exitSignal) break;
+            if (item.first->isLoaded()) continue;
+            TRACE_SCOPE("load_track", 0);
+            item.first->load(item.second, frameSize);
         }
+    });
+    blockExitSignals(false);
+
+    if (resume) {
+        // Loading took time; rejoin at the first frame that is not yet due
+        clock_gettime(CLOCK_MONOTONIC, &monoNow);
+        f = timeline.nextActiveFrame(std::max<int64_t>(framesSince(anchor, monoNow), 0));
+        std::cout << "[RESUME] rejoining at frame " << f << " of " << timeline.endFrame() << std::endl;
     }
-    
-    // Turn off all LEDs after playback
-    for (int i = 0; i < 16; ++i) {
-        setLED(i, 0, 0, 0);
+
+    // Each frame is prepared right after the previous one is written, so a
+    // boundary between entries costs nothing extra at its deadline.
+    const uint8_t* frame = timeline.frame(f);
+    while (f < timeline.endFrame() && !exitSignal) {
+        struct timespec deadline = frameDeadline(anchor, f);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR && !exitSignal) {
+        }
+        if (exitSignal) break;
+        TRACE_INSTANT("wake_late_ns", traceLateNs(deadline));
+
+        {
+            TRACE_SCOPE("show_frame", f);
+            leds.showFrame(frame, dronePixel * dronePixel);
+        }
+        int entry = timeline.entryAt(f);
+        checkpoint.publish(entry, f);
+
+        // In a gap the LEDs were just turned off; skip ahead to the next entry.
+        // After a resume, an entry whose frames are still loading plays dark but keeps time.
+        f = timeline.nextFrame(f);
+        TRACE_SCOPE("render", f);
+        frame = timeline.frame(f);
     }
 
+    // A run cut short by a signal keeps its checkpoint so the next start rejoins it
+    if (exitSignal) std::cout << "\n[강제종료] " << std::endl;
+    else checkpoint.clear();
+    loader.join();
+
+    // Turn off all LEDs after playback
+    leds.off();
+
+    asyncLogFlush();
+    TRACE_DUMP();
     return 0;
 }
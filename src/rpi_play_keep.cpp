@@ -6,25 +6,33 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include <csignal>
 #include <iomanip>
 #include <time.h>
 #include <sstream>
 #include <nlohmann/json.hpp>
 #include "./lib/PCA9635_RPI.h"
+#include "./lib/ShowTrack.h"
+#include "./lib/Timeline.h"
+#include "./lib/DroneLeds.h"
+#include "./lib/EventSignal.h"
+#include "./lib/AsyncLog.h"
+#include "./lib/Trace.h"
 
 PCA9635 pca1(0x40);
 PCA9635 pca2(0x41);
 PCA9635 pca3(0x42);
+DroneLeds leds(pca1, pca2, pca3);
 
-std::map<std::string, std::vector<std::vector<uint8_t>>> binDataMap;
+std::map<std::string, ShowTrack> trackMap;
 std::chrono::steady_clock::time_point lastTimeA, lastTimeB, lastTimeC;
 const int COMMAND_COOLDOWN_MS = 5000; 
 
 bool running = true;
 bool isPlaying = false;
-int fileIndex = 0;
-int frameIndex = 0;
+std::atomic<int> nextPending(0);   // NEXT presses the main loop has not applied yet
+EventSignal wakeEvent;   // PLAY/PAUSE/NEXT and shutdown wake the idle player
 uint32_t lastTick = 0;
 int dronePixel = 4; 
 int frameSize = 48;
@@ -36,53 +44,9 @@ const uint32_t PW_C = 1100;
 const int TOL = 10;
 
 std::vector<std::string> fileLists;
-std::string currentFilename;
-std::vector<std::vector<uint8_t>> currentFrames;
 
 const std::string SAVE_DIR = "./src/bin_files/";
 
-// Define LED control structures
-struct Channel {
-    PCA9635* pca;
-    int ch;
-};
-
-struct RGBChannel {
-    Channel r, g, b;
-};
-
-// Map LED index (0~15) to the corresponding RGB PCA9635 channels
-RGBChannel getLEDChannel(int ledIndex) {
-    switch (ledIndex) {
-        case 0: return {{&pca1, 0}, {&pca1, 1}, {&pca1, 2}};
-        case 1: return {{&pca1, 3}, {&pca1, 4}, {&pca1, 5}};
-        case 2: return {{&pca1, 6}, {&pca1, 7}, {&pca1, 8}};
-        case 3: return {{&pca1, 9}, {&pca1, 10}, {&pca1, 11}};
-        case 4: return {{&pca1, 12}, {&pca1, 13}, {&pca1, 14}};
-        case 5: return {{&pca1, 15}, {&pca2, 0}, {&pca2, 1}};
-        case 6: return {{&pca2, 2}, {&pca2, 3}, {&pca2, 4}};
-        case 7: return {{&pca2, 5}, {&pca2, 6}, {&pca2, 7}};
-        case 8: return {{&pca2, 8}, {&pca2, 9}, {&pca2, 10}};
-        case 9: return {{&pca2, 11}, {&pca2, 12}, {&pca2, 13}};
-        case 10:return {{&pca2, 14}, {&pca2, 15}, {&pca3, 0}};
-        case 11:return {{&pca3, 1}, {&pca3, 2}, {&pca3, 3}};
-        case 12:return {{&pca3, 4}, {&pca3, 5}, {&pca3, 6}};
-        case 13:return {{&pca3, 7}, {&pca3, 8}, {&pca3, 9}};
-        case 14:return {{&pca3, 10}, {&pca3, 11}, {&pca3, 12}};
-        case 15:return {{&pca3, 13}, {&pca3, 14}, {&pca3, 15}};
-        default:return {{nullptr, -1}, {nullptr, -1}, {nullptr, -1}};
-    }
-}
-
-void setLED(int ledIndex, uint8_t r, uint8_t g, uint8_t b) {
-    RGBChannel ch = getLEDChannel(ledIndex);
-    int r_fixed = r * 2/3 ;
-    int b_fixed = b * 2/3 ;
-    if (ch.r.pca && ch.r.ch >= 0) ch.r.pca->analogWrite(ch.r.ch, r_fixed);
-    if (ch.g.pca && ch.g.ch >= 0) ch.g.pca->analogWrite(ch.g.ch, g);
-    if (ch.b.pca && ch.b.ch >= 0) ch.b.pca->analogWrite(ch.b.ch, b_fixed);
-}
-
 // void setLED(int ledIndex, uint8_t r, uint8_t g, uint8_t b) {
 //     constexpr int Rmax = 180; 
 //     constexpr int Gmax = 250; 
@@ -106,33 +70,30 @@ void setLED(int ledIndex, uint8_t r, uint8_t g, uint8_t b) {
 
 void handleSignal(int s) {
     running = false;
+    wakeEvent.notify();
 }
 
-void loadCurrentFile() {
-    if (fileIndex >= fileLists.size()) return;
-    currentFilename = fileLists[fileIndex];
-    if (binDataMap.find(currentFilename) == binDataMap.end()) {
-        std::ifstream bin(SAVE_DIR + currentFilename, std::ios::binary);
-        if (!bin) return;
-        bin.seekg(32, std::ios::beg);
-        std::vector<std::vector<uint8_t>> frames;
-        while (true) {
-            std::vector<uint8_t> frame(frameSize);
-            bin.read(reinterpret_cast<char*>(frame.data()), frameSize);
-            if (bin.gcount() != frameSize) break;
-            frames.push_back(frame);
+// Every entry is loaded up front so crossing into the next one never waits on disk.
+// A file that fails to load stays as an empty track and is skipped on the timeline.
+void loadAllFiles() {
+    for (const auto& filename : fileLists) {
+        if (trackMap.find(filename) != trackMap.end()) continue;
+        TRACE_SCOPE("load_track", 0);
+        if (!trackMap[filename].load(SAVE_DIR + filename, frameSize)) {
+            std::cerr << "[ERROR] Failed to load " << filename << std::endl;
         }
-        binDataMap[currentFilename] = std::move(frames);
     }
-    currentFrames = binDataMap[currentFilename];
+    FrameStore& store = FrameStore::shared(frameSize);
+    std::cout << "[LOAD] " << store.uniqueFrames() << " unique frames, "
+              << store.residentBytes() / 1024 << " KB resident" << std::endl;
 }
 
-
 void pwmCallback(int gpio, int level, uint32_t tick) {
   if (level == 1) {
         lastTick = tick;
     } else if (level == 0) {
         uint32_t pw = tick - lastTick;
+        TRACE_SCOPE("pwm_callback", pw);
         auto now = std::chrono::steady_clock::now();
 
         // PW_A: NEXT
@@ -141,11 +102,10 @@ void pwmCallback(int gpio, int level, uint32_t tick) {
             if (diff < COMMAND_COOLDOWN_MS) return;
             lastTimeA = now;
 
-            fileIndex = (fileIndex + 1) % fileLists.size();
-            frameIndex = 0;
             isPlaying = false;
-            loadCurrentFile();
-            std::cout << "[NEXT] fileIndex=" << fileIndex << std::endl;
+            nextPending.fetch_add(1);
+            wakeEvent.notify();
+            LOG_INFO("[NEXT]", 0, 0);
         }
 
         // PW_B: PLAY
@@ -155,7 +115,8 @@ void pwmCallback(int gpio, int level, uint32_t tick) {
             lastTimeB = now;
 
             isPlaying = true;
-            std::cout << "[PLAY]" << std::endl;
+            wakeEvent.notify();
+            LOG_INFO("[PLAY]", 0, 0);
         }
 
         // PW_C: PAUSE
@@ -165,7 +126,8 @@ void pwmCallback(int gpio, int level, uint32_t tick) {
             lastTimeC = now;
 
             isPlaying = false;
-            std::cout << "[PAUSE]" << std::endl;
+            wakeEvent.notify();
+            LOG_INFO("[PAUSE]", 0, 0);
         }
     }
 }
@@ -174,10 +136,12 @@ void cleanupAndExit(int exitCode) {
     std::cerr << "[EXIT] Cleaning up..." << std::endl;
 
     // Turn off all LEDs
-    for (int i = 0; i < 16; ++i) setLED(i, 0, 0, 0);
+    leds.off();
 
     // Stop pigpio
     gpioTerminate();
+    asyncLogFlush();
+    TRACE_DUMP();
 
     std::cerr << "[EXIT] Done. Exiting with code " << exitCode << std::endl;
     exit(exitCode);
@@ -214,15 +178,25 @@ int main(int argc, char* argv[]) {
     signal(SIGINT, handleSignal);
     signal(SIGTERM, handleSignal);
 
+    asyncLogStart();
+    TRACE_INIT("./rpi_play_keep_trace.json");
+
     if (gpioInitialise() < 0) {
         std::cerr << "[ERROR] pigpio init failed" << std::endl;
+        asyncLogFlush();
         return 1;
     }
+    // gpioInitialise() installs its own handler for every signal; ours only
+    // run if registered through pigpio
+    gpioSetSignalFunc(SIGINT, handleSignal);
+    gpioSetSignalFunc(SIGTERM, handleSignal);
+    TRACE_PIGPIO_SIGNAL();
     gpioSetMode(PWM_GPIO, PI_INPUT);
     gpioSetAlertFunc(PWM_GPIO, pwmCallback);
 
     if (!pca1.begin() || !pca2.begin() || !pca3.begin()) {
         std::cerr << "[ERROR] PCA9635 init failed" << std::endl;
+        asyncLogFlush();   // the driver's queued errors say why
         return 1;
     }
 
@@ -230,45 +204,86 @@ int main(int argc, char* argv[]) {
     std::ifstream f(scheduleName);
     nlohmann::json j;
     f >> j;
-    for (auto& item : j) fileLists.push_back(item["filename"]);
-    
-    loadCurrentFile();
-    std::cout << "currentFrames.size(): " << currentFrames.size() << std::endl;
-    
-    const int interval_us = 30'000;
-    struct timespec nextFrameTime;
-    clock_gettime(CLOCK_MONOTONIC, &nextFrameTime);
+    std::vector<std::pair<uint32_t, uint32_t>> entryOptions;  // loop, crossfade
+    for (auto& item : j) {
+        fileLists.push_back(item["filename"]);
+        entryOptions.push_back({ item.value("loop", 1), item.value("crossfade", 0) });
+    }
+    if (fileLists.empty()) {
+        std::cerr << "[ERROR] Empty playlist" << std::endl;
+        asyncLogFlush();
+        return 1;
+    }
     
+    loadAllFiles();
+
+    // The whole playlist on one clock: PLAY runs from the selected entry through
+    // the following ones back to back, honouring loop counts and crossfades.
+    Timeline timeline(frameSize);
+    for (size_t i = 0; i < fileLists.size(); ++i) {
+        timeline.append(&trackMap[fileLists[i]], entryOptions[i].first, entryOptions[i].second);
+    }
+    std::cout << "timeline frames: " << timeline.endFrame() << std::endl;
+
+    uint64_t playFrame = 0;   // next timeline frame to show
+    uint64_t playStart = 0;   // where the selected entry starts; rewound to at the end
+    int fileIndex = 0;        // entry selected or playing; only the main thread touches it
+    bool wasPlaying = false;
+    struct timespec anchor;
+    const uint8_t* frame = nullptr;
+
     while (running) {
-        if (isPlaying && !currentFrames.empty()) {
-            for (; frameIndex < currentFrames.size(); ++frameIndex) {
-                if (!isPlaying) break;
-                
-                auto& frame = currentFrames[frameIndex];
-                for (int i = 0; i < dronePixel * dronePixel; ++i) {
-                    setLED(i, frame[i*3+0], frame[i*3+1], frame[i*3+2]);
-                }
-
-                nextFrameTime.tv_nsec += interval_us * 1000;
-                if (nextFrameTime.tv_nsec >= 1000000000) {
-                    nextFrameTime.tv_sec += 1;
-                    nextFrameTime.tv_nsec -= 1000000000;
-                }
-
-                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextFrameTime, nullptr);
+        int skips = nextPending.exchange(0);
+        if (skips > 0) {
+            fileIndex = (fileIndex + skips) % fileLists.size();
+            LOG_INFO("[NEXT] fileIndex=%lld", fileIndex, 0);
+            playStart = playFrame = timeline.entry(fileIndex).startFrame;
+            timeline.startAt(playStart);
+            wasPlaying = false;
+        }
+
+        if (isPlaying && playFrame < timeline.endFrame()) {
+            if (!wasPlaying) {
+                // Starting or resuming: put playFrame on the clock right now
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                anchor = anchorForFrame(now, playFrame);
+                frame = timeline.frame(playFrame);
+                wasPlaying = true;
             }
 
-            if (frameIndex >= currentFrames.size()) {
-                frameIndex = 0;
-                isPlaying = false;
+            struct timespec deadline = frameDeadline(anchor, playFrame);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+            TRACE_INSTANT("wake_late_ns", traceLateNs(deadline));
+            {
+                TRACE_SCOPE("show_frame", playFrame);
+                leds.showFrame(frame, dronePixel * dronePixel);
             }
+
+            // Prepare the next frame now, well before its deadline
+            ++playFrame;
+            int entry = timeline.entryAt(playFrame);
+            if (entry >= 0) fileIndex = entry;
+            TRACE_SCOPE("render", playFrame);
+            frame = timeline.frame(playFrame);
         } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (isPlaying) {
+                // Ran off the end of the playlist
+                isPlaying = false;
+                playFrame = playStart;
+                int entry = timeline.entryAt(playStart);
+                if (entry >= 0) fileIndex = entry;
+            }
+            wasPlaying = false;
+            // Sleep until a command arrives; a PLAY sent before this point is not lost
+            wakeEvent.wait();
         }
     }
 
-    for (int i = 0; i < 16; ++i) setLED(i, 0, 0, 0);
+    leds.off();
     gpioTerminate();
+    asyncLogFlush();
+    TRACE_DUMP();
     return 0;
 }
 
@@ -6,6 +6,9 @@
 #include <cstdlib>
 #include <unistd.h>
 #include <sys/wait.h>
+#include "./lib/EventSignal.h"
+#include "./lib/AsyncLog.h"
+#include "./lib/Trace.h"
 
 const int PWM_GPIO = 18;
 const uint32_t PW_PLAY = 1000;
@@ -18,6 +21,8 @@ std::chrono::steady_clock::time_point lastCommandTime;
 std::string jsonFilePath;
 int playIndex;
 pid_t childPid = -1;
+volatile sig_atomic_t exitSignal = 0;
+EventSignal exitEvent;
 
 void cleanup(int code) {
     if (childPid > 0) {
@@ -27,12 +32,15 @@ void cleanup(int code) {
     }
     gpioTerminate();
     std::cerr << "[EXIT] GPIO cleaned up.\n";
+    asyncLogFlush();
+    TRACE_DUMP();
     exit(code);
 }
 
+// Cleanup runs on the main thread; the handler only records the signal and wakes it
 void signalHandler(int sig) {
-    std::cerr << "[SIGNAL] Terminated by signal " << sig << "\n";
-    cleanup(0);
+    exitSignal = sig;
+    exitEvent.notify();
 }
 
 void pwmCallback(int gpio, int level, uint32_t tick) {
@@ -40,10 +48,11 @@ void pwmCallback(int gpio, int level, uint32_t tick) {
         lastTick = tick;
     } else if (level == 0) {
         uint32_t pw = tick - lastTick;
+        TRACE_SCOPE("pwm_callback", pw);
         auto now = std::chrono::steady_clock::now();
         int diff = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastCommandTime).count();
         if (diff < COOLDOWN_MS) {
-            std::cout << "[SKIP] Cooldown " << diff << "ms\n";
+            LOG_INFO("[SKIP] Cooldown %lldms", diff, 0);
             return;
         }
 
@@ -51,12 +60,12 @@ void pwmCallback(int gpio, int level, uint32_t tick) {
             lastCommandTime = now;
 
             if (childPid > 0) {
-                std::cerr << "[INFO] Killing existing rpi_play (pid=" << childPid << ")\n";
+                LOG_INFO("[INFO] Killing existing rpi_play (pid=%lld)", childPid, 0);
                 kill(childPid, SIGTERM);
                 waitpid(childPid, nullptr, 0);
             }
 
-            std::cout << "[TRIGGER] Executing rpi_play...\n";
+            LOG_INFO("[TRIGGER] Executing rpi_play...", 0, 0);
 
             childPid = fork();
             if (childPid == 0) {
@@ -69,7 +78,7 @@ void pwmCallback(int gpio, int level, uint32_t tick) {
                 std::cerr << "[ERROR] Failed to exec rpi_play\n";
                 exit(1);
             } else if (childPid < 0) {
-                std::cerr << "[ERROR] fork failed\n";
+                LOG_ERRNO("fork failed", 0, 0);
             }
         }
     }
@@ -88,19 +97,29 @@ int main(int argc, char* argv[]) {
     jsonFilePath = argv[1];
     playIndex = std::stoi(argv[2]);
 
+    asyncLogStart();
+    TRACE_INIT("./rpi_play_pwm_trace.json");
+
     if (gpioInitialise() < 0) {
         std::cerr << "[ERROR] pigpio init failed.\n";
+        asyncLogFlush();
         return 1;
     }
+    // gpioInitialise() installs its own handler for every signal; ours only
+    // run if registered through pigpio
+    gpioSetSignalFunc(SIGINT, signalHandler);
+    gpioSetSignalFunc(SIGTERM, signalHandler);
+    TRACE_PIGPIO_SIGNAL();
 
     gpioSetMode(PWM_GPIO, PI_INPUT);
     gpioSetAlertFunc(PWM_GPIO, pwmCallback);
 
     std::cout << "[READY] Waiting for PWM trigger on GPIO " << PWM_GPIO << "...\n";
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    while (!exitSignal) {
+        exitEvent.wait();
     }
 
+    std::cerr << "[SIGNAL] Terminated by signal " << exitSignal << "\n";
     cleanup(0);
     return 0;
 }
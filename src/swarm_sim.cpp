@@ -0,0 +1,357 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "./lib/PCA9635_RPI.h"
+#include "./lib/ShowTrack.h"
+#include "./lib/Timeline.h"
+#include "./lib/Schedule.h"
+#include "./lib/DroneLeds.h"
+
+// Swarm simulator: runs N virtual drones through rpi_play's schedule parsing,
+// timeline layout, frame clock and LED/PCA9635 driver code, on simulated I2C
+// buses and in virtual time, then reports how far apart the drones put each
+// frame on their LEDs.
+//
+// Per drone it injects
+//   - crystal skew: the local clock runs at 1 + U(-skew, +skew) ppm
+//   - wall clock offset: N(0, offset) ms error in the time the schedule starts at
+//   - bus latency: every I2C transfer costs bus + Exp(bus jitter) us
+//   - scheduler wake-up: every frame deadline is met Exp(wake) us late
+//   - trigger jitter (trigger mode): PLAY arrives U(0, jitter) ms after broadcast
+//
+// Usage: ./swarm_sim <playlist.json> <pixel_size> [--drones N] [--mode schedule|trigger]
+//        [--skew-ppm X] [--offset-ms X] [--bus-us X] [--bus-jitter-us X] [--wake-us X]
+//        [--trigger-jitter-ms X] [--frames N] [--seed N]
+
+const std::string SAVE_DIR = "./src/bin_files/";
+const int64_t SHOW_START_NS = 1000000000;   // true time of the first scheduled entry, or of the trigger
+
+struct SimConfig {
+    int drones = 100;
+    bool triggerMode = false;
+    double skewPpm = 20;
+    double offsetMs = 2;
+    double busUs = 100;
+    double busJitterUs = 20;
+    double wakeUs = 50;
+    double triggerJitterMs = 5;
+    uint64_t maxFrames = 0;   // 0 = whole timeline
+    uint64_t seed = 1;
+};
+
+// I2C bus of one drone: keeps the PCA9635 register files so the driver's
+// read-modify-write cycles behave, and charges every transfer to the drone's clock
+class SimBus : public I2CTransport {
+public:
+    SimBus(const SimConfig& cfg, std::mt19937_64& rng)
+        : rng(rng), jitter(cfg.busJitterUs > 0 ? 1.0 / (cfg.busJitterUs * 1000) : 1.0) {
+        baseNs = static_cast<int64_t>(cfg.busUs * 1000);
+        hasJitter = cfg.busJitterUs > 0;
+        now = 0;
+        transfers = 0;
+        std::memset(regs, 0, sizeof(regs));
+        std::memset(pointer, 0, sizeof(pointer));
+    }
+
+    int write(uint8_t addr, const uint8_t* buf, int len) override {
+        charge();
+        pointer[addr & 0x7f] = buf[0] & 0x1f;
+        if (len >= 2) regs[addr & 0x7f][buf[0] & 0x1f] = buf[1];
+        return len;
+    }
+
+    int read(uint8_t addr, uint8_t* buf, int len) override {
+        charge();
+        for (int i = 0; i < len; ++i) buf[i] = regs[addr & 0x7f][pointer[addr & 0x7f]];
+        return len;
+    }
+
+    int64_t now;         // true time of this drone, in ns
+    uint64_t transfers;
+
+private:
+    std::mt19937_64& rng;
+    std::exponential_distribution<double> jitter;
+    int64_t baseNs;
+    bool hasJitter;
+    uint8_t regs[128][32];
+    uint8_t pointer[128];
+
+    void charge() {
+        now += baseNs + (hasJitter ? static_cast<int64_t>(jitter(rng)) : 0);
+        ++transfers;
+    }
+};
+
+// Three boards on one bus, wired like the real drone
+class SimDrone {
+public:
+    SimDrone(const SimConfig& cfg, std::mt19937_64& rng)
+        : bus(cfg, rng), leds(pca1, pca2, pca3), pca1(0x40, &bus), pca2(0x41, &bus), pca3(0x42, &bus) {
+    }
+
+    bool begin() { return pca1.begin() && pca2.begin() && pca3.begin(); }
+
+    SimBus bus;
+    DroneLeds leds;   // only keeps the boards' addresses
+
+private:
+    PCA9635 pca1, pca2, pca3;
+};
+
+struct ShownFrame {
+    uint64_t frame;   // timeline frame
+    int64_t at;       // true time it was fully on the LEDs
+};
+
+struct DroneResult {
+    std::vector<ShownFrame> shown;   // in frame order; gaps are not recorded
+    double skewPpm;
+    double offsetMs;
+    uint64_t lateFrames;             // frames started more than 1 ms after their deadline
+    uint64_t transfers;
+    int64_t busNs;
+};
+
+// launchWall: wall clock time at true time 0, as a perfect clock would read it
+void simulateDrone(int index, const SimConfig& cfg, const std::vector<ScheduleEntry>& schedule,
+                   const std::map<std::string, ShowTrack>& tracks, std::chrono::system_clock::time_point launchWall,
+                   int frameSize, DroneResult& result) {
+    std::mt19937_64 rng(cfg.seed * 1000003 + index);
+    std::uniform_real_distribution<double> skewDist(-cfg.skewPpm, cfg.skewPpm);
+    std::normal_distribution<double> offsetDist(0.0, cfg.offsetMs);
+    std::uniform_real_distribution<double> triggerDist(0.0, cfg.triggerJitterMs);
+    std::exponential_distribution<double> wakeDist(cfg.wakeUs > 0 ? 1.0 / (cfg.wakeUs * 1000) : 1.0);
+
+    result.skewPpm = cfg.skewPpm > 0 ? skewDist(rng) : 0;
+    result.offsetMs = cfg.offsetMs > 0 ? offsetDist(rng) : 0;
+    const double rate = 1.0 + result.skewPpm * 1e-6;   // local ns per true ns
+
+    // The player starts at true time 0 (schedule mode) or when PLAY reaches it
+    // (trigger mode), reads its own wall clock and lays out the timeline as rpi_play does
+    int64_t launchNs = cfg.triggerMode
+        ? SHOW_START_NS + static_cast<int64_t>((cfg.triggerJitterMs > 0 ? triggerDist(rng) : 0) * 1e6)
+        : 0;
+    auto sysNow = launchWall + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(launchNs + static_cast<int64_t>(result.offsetMs * 1e6)));
+    auto origin = scheduleOrigin(schedule, sysNow);
+    Timeline timeline(frameSize);
+    layoutSchedule(timeline, schedule, tracks, origin);
+
+    // rpi_play anchors frame 0 at monoNow + (origin - sysNow) on its local clock
+    const double anchorNs = launchNs +
+        std::chrono::duration_cast<std::chrono::nanoseconds>(origin - sysNow).count() / rate;
+    uint64_t frameLimit = timeline.endFrame();
+    if (cfg.maxFrames > 0) frameLimit = std::min(frameLimit, cfg.maxFrames);
+
+    // Board setup happens before the player reads its clocks
+    SimDrone drone(cfg, rng);
+    drone.begin();
+    drone.bus.now = launchNs;
+    const uint64_t initTransfers = drone.bus.transfers;
+
+    result.shown.clear();
+    result.lateFrames = 0;
+    result.busNs = 0;
+
+    uint64_t f = timeline.nextActiveFrame(0);
+    const uint8_t* frame = timeline.frame(f);
+    while (f < frameLimit) {
+        // clock_nanosleep on the local clock, plus the scheduler's wake-up delay;
+        // a frame that overran its slot starts the next one immediately
+        int64_t deadline = static_cast<int64_t>(anchorNs + f * FRAME_INTERVAL_NS / rate);
+        int64_t start = drone.bus.now > deadline
+            ? drone.bus.now
+            : deadline + (cfg.wakeUs > 0 ? static_cast<int64_t>(wakeDist(rng)) : 0);
+        if (start - deadline > 1000000) ++result.lateFrames;
+
+        drone.bus.now = start;
+        drone.leds.showFrame(frame, frameSize / 3);
+        result.busNs += drone.bus.now - start;
+        result.shown.push_back({ f, drone.bus.now });
+
+        f = timeline.nextFrame(f);
+        frame = timeline.frame(f);
+    }
+    result.transfers = drone.bus.transfers - initTransfers;
+}
+
+double percentile(std::vector<int64_t>& values, double p) {
+    if (values.empty()) return 0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k] / 1e6;
+}
+
+bool parseArgs(int argc, char* argv[], SimConfig& cfg) {
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "[ERROR] Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--drones") cfg.drones = std::stoi(value);
+        else if (arg == "--mode") cfg.triggerMode = (value == "trigger");
+        else if (arg == "--skew-ppm") cfg.skewPpm = std::stod(value);
+        else if (arg == "--offset-ms") cfg.offsetMs = std::stod(value);
+        else if (arg == "--bus-us") cfg.busUs = std::stod(value);
+        else if (arg == "--bus-jitter-us") cfg.busJitterUs = std::stod(value);
+        else if (arg == "--wake-us") cfg.wakeUs = std::stod(value);
+        else if (arg == "--trigger-jitter-ms") cfg.triggerJitterMs = std::stod(value);
+        else if (arg == "--frames") cfg.maxFrames = std::stoull(value);
+        else if (arg == "--seed") cfg.seed = std::stoull(value);
+        else {
+            std::cerr << "[ERROR] Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return cfg.drones > 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <playlist.json> <pixel_size> [--drones N] [--mode schedule|trigger]\n"
+                  << "       [--skew-ppm X] [--offset-ms X] [--bus-us X] [--bus-jitter-us X] [--wake-us X]\n"
+                  << "       [--trigger-jitter-ms X] [--frames N] [--seed N]\n";
+        return 1;
+    }
+
+    SimConfig cfg;
+    if (!parseArgs(argc, argv, cfg)) return 1;
+
+    int dronePixel = std::stoi(argv[2]);
+    int frameSize = dronePixel * dronePixel * 3;
+
+    auto schedule = loadSchedule(argv[1]);
+    std::map<std::string, ShowTrack> tracks;
+    for (const auto& entry : schedule) {
+        if (tracks.find(entry.filename) == tracks.end()) {
+            if (!tracks[entry.filename].load(SAVE_DIR + entry.filename, frameSize)) return 1;
+        }
+    }
+    if (schedule.empty()) {
+        std::cerr << "[ERROR] Empty playlist\n";
+        return 1;
+    }
+
+    // Schedule mode starts the players SHOW_START_NS before the earliest timed
+    // entry; trigger mode (or a playlist without times) starts them now
+    auto launchWall = std::chrono::system_clock::now();
+    if (!cfg.triggerMode) {
+        bool timed = false;
+        for (const auto& entry : schedule) {
+            if (entry.hasTime && (!timed || entry.playTime < launchWall)) launchWall = entry.playTime;
+            timed = timed || entry.hasTime;
+        }
+        if (timed) launchWall -= std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(SHOW_START_NS));
+    }
+
+    std::printf("[SIM] %d drones, %zu entries, %s mode, seed %llu\n",
+                cfg.drones, schedule.size(), cfg.triggerMode ? "trigger" : "schedule",
+                static_cast<unsigned long long>(cfg.seed));
+    std::printf("[SIM] skew +-%.1f ppm, wall offset sd %.2f ms, bus %.0f us + Exp(%.0f us), wake Exp(%.0f us)",
+                cfg.skewPpm, cfg.offsetMs, cfg.busUs, cfg.busJitterUs, cfg.wakeUs);
+    if (cfg.triggerMode) std::printf(", trigger jitter U(0, %.1f ms)", cfg.triggerJitterMs);
+    std::printf("\n");
+
+    // Drones are independent, so they are spread over worker threads. Tracks
+    // are shared read-only; each drone lays out its own Timeline from its own clock.
+    std::vector<DroneResult> results(cfg.drones);
+    int workers = std::max(1, std::min<int>(cfg.drones, std::thread::hardware_concurrency()));
+    auto wallStart = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w]() {
+            for (int i = w; i < cfg.drones; i += workers) {
+                simulateDrone(i, cfg, schedule, tracks, launchWall, frameSize, results[i]);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // Per timeline frame shown by every drone: spread across the swarm and each
+    // drone's deviation from the median. Drone 0's frames drive the walk.
+    std::vector<int64_t> spreads;
+    std::vector<int64_t> column(cfg.drones);
+    std::vector<size_t> cursor(cfg.drones, 0);
+    std::vector<double> devSum(cfg.drones, 0), devMax(cfg.drones, 0);
+    uint64_t framesCompared = 0;
+    int64_t firstSpread = 0, lastSpread = 0;
+    for (const ShownFrame& ref : results[0].shown) {
+        bool everyone = true;
+        for (int i = 0; i < cfg.drones && everyone; ++i) {
+            const std::vector<ShownFrame>& shown = results[i].shown;
+            while (cursor[i] < shown.size() && shown[cursor[i]].frame < ref.frame) ++cursor[i];
+            everyone = cursor[i] < shown.size() && shown[cursor[i]].frame == ref.frame;
+            if (everyone) column[i] = shown[cursor[i]].at;
+        }
+        if (!everyone) continue;
+
+        auto minmax = std::minmax_element(column.begin(), column.end());
+        int64_t spread = *minmax.second - *minmax.first;
+        if (framesCompared == 0) firstSpread = spread;
+        lastSpread = spread;
+        spreads.push_back(spread);
+
+        std::vector<int64_t> sorted(column);
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        int64_t median = sorted[sorted.size() / 2];
+        for (int i = 0; i < cfg.drones; ++i) {
+            double dev = (column[i] - median) / 1e6;
+            devSum[i] += dev;
+            devMax[i] = std::max(devMax[i], std::fabs(dev));
+        }
+        ++framesCompared;
+    }
+    if (framesCompared == 0) {
+        std::cerr << "[ERROR] Nothing was shown\n";
+        return 1;
+    }
+
+    double spreadMean = 0;
+    for (int64_t s : spreads) spreadMean += s / 1e6;
+    spreadMean /= spreads.size();
+
+    std::printf("[SIM] frame time divergence across the swarm (ms): mean %.3f  p50 %.3f  p99 %.3f  max %.3f\n",
+                spreadMean, percentile(spreads, 0.5), percentile(spreads, 0.99), percentile(spreads, 1.0));
+    std::printf("[SIM] %llu frames compared; divergence at first frame %.3f ms, at last frame %.3f ms\n",
+                static_cast<unsigned long long>(framesCompared), firstSpread / 1e6, lastSpread / 1e6);
+
+    uint64_t lateTotal = 0, outOfSync = 0;
+    double busMs = 0, transfers = 0;
+    for (int i = 0; i < cfg.drones; ++i) {
+        lateTotal += results[i].lateFrames;
+        if (devMax[i] > FRAME_INTERVAL_NS / 1e6) ++outOfSync;
+        size_t shown = std::max<size_t>(results[i].shown.size(), 1);
+        busMs += results[i].busNs / 1e6 / shown;
+        transfers += static_cast<double>(results[i].transfers) / shown;
+    }
+    std::printf("[SIM] bus time per frame %.2f ms (%.0f transfers), late frames %llu, drones off by more than a frame: %llu\n",
+                busMs / cfg.drones, transfers / cfg.drones,
+                static_cast<unsigned long long>(lateTotal), static_cast<unsigned long long>(outOfSync));
+
+    std::vector<int> order(cfg.drones);
+    for (int i = 0; i < cfg.drones; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return devMax[a] > devMax[b]; });
+    std::printf("[SIM] worst drones (deviation from swarm median):\n");
+    for (int k = 0; k < std::min(cfg.drones, 5); ++k) {
+        int i = order[k];
+        std::printf("  drone %4d: mean %+8.3f ms  max %7.3f ms  skew %+6.1f ppm  offset %+6.2f ms  late %llu\n",
+                    i, devSum[i] / framesCompared, devMax[i], results[i].skewPpm, results[i].offsetMs,
+                    static_cast<unsigned long long>(results[i].lateFrames));
+    }
+    std::printf("[SIM] simulated in %.1f s on %d threads\n", wallSec, workers);
+    return 0;
+}